@@ -0,0 +1,283 @@
+#include "asset_atlas.h"
+
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#include <QDir>
+#include <QImage>
+#include <QSaveFile>
+#include <QImageReader>
+#include <QCryptographicHash>
+
+static constexpr auto img_name_lock_locked = "lock_locked.png";
+static constexpr auto img_name_lock_unlocked = "lock_unlocked.png";
+static constexpr auto img_name_horizontal_vertical_anim = "horizontal_vertical.gif";
+static constexpr auto img_name_vertical_horizontal_anim = "vertical_horizontal.gif";
+
+// Used if animations do not define their frame delay
+static constexpr int default_frame_delay_ms{ 40 };
+
+static constexpr uint32_t atlas_magic{ 0x54414b4c }; // "LKAT"
+static constexpr uint32_t atlas_version{ 1 };
+
+// Followed by the locked and the unlocked lock, then the frames of both animations,
+// every image is width * height premultiplied ARGB32 pixels
+struct atlas_header
+{
+    uint32_t magic{ atlas_magic };
+    uint32_t version{ atlas_version };
+    uint32_t width{ 0 };
+    uint32_t height{ 0 };
+    uint32_t frame_delay{ 0 };
+    uint32_t to_horizontal_num{ 0 };
+    uint32_t to_vertical_num{ 0 };
+    uint32_t reserved{ 0 };
+};
+
+static_assert( sizeof( atlas_header ) % 4 == 0, "Images should stay 32 bit aligned" );
+
+struct decoded_assets
+{
+    int frame_delay{ 0 };
+    QImage lock_locked;
+    QImage lock_unlocked;
+    QVector< QImage > to_horizontal_frames;
+    QVector< QImage > to_vertical_frames;
+};
+
+QString get_image_name( const data_state& state )
+{
+    QString img_name;
+
+    switch( state )
+    {
+    case data_state::lock_locked: img_name = img_name_lock_locked; break;
+    case data_state::lock_unlocked: img_name = img_name_lock_unlocked; break;
+    case data_state::switch_horizontal: img_name = img_name_vertical_horizontal_anim; break;
+    case data_state::switch_vertical: img_name = img_name_horizontal_vertical_anim; break;
+    }
+
+    return QString( ":/graphics/%1" ).arg( img_name );
+}
+
+// Any change of the images gets a new cache file
+QString get_resources_hash()
+{
+    QCryptographicHash hash{ QCryptographicHash::Sha1 };
+
+    for( const data_state& state : { data_state::lock_locked, data_state::lock_unlocked,
+                                     data_state::switch_horizontal, data_state::switch_vertical } )
+    {
+        QFile file{ get_image_name( state ) };
+        if( file.open( QFile::ReadOnly ) )
+        {
+            hash.addData( file.readAll() );
+        }
+    }
+
+    return QString::fromLatin1( hash.result().toHex().left( 16 ) );
+}
+
+QImage load_lock( const data_state& state, const QSize& image_size )
+{
+    return QImage{ get_image_name( state ) }.scaled( image_size )
+                                            .convertToFormat( QImage::Format_ARGB32_Premultiplied );
+}
+
+int load_frames( const data_state& state, const QSize& image_size, QVector< QImage >& frames )
+{
+    QImageReader reader{ get_image_name( state ) };
+    reader.setScaledSize( image_size );
+
+    int frame_delay{ 0 };
+    QImage frame;
+    while( reader.read( &frame ) )
+    {
+        if( frames.empty() )
+        {
+            frame_delay = reader.nextImageDelay();
+        }
+
+        frames.push_back( frame.convertToFormat( QImage::Format_ARGB32_Premultiplied ) );
+    }
+
+    if( frames.empty() )
+    {
+        throw std::runtime_error{ "Failed to load animation" };
+    }
+
+    return frame_delay > 0? frame_delay : default_frame_delay_ms;
+}
+
+decoded_assets decode_resources( const QSize& image_size )
+{
+    decoded_assets assets;
+    assets.lock_locked = load_lock( data_state::lock_locked, image_size );
+    assets.lock_unlocked = load_lock( data_state::lock_unlocked, image_size );
+    assets.frame_delay = std::min( load_frames( data_state::switch_horizontal, image_size, assets.to_horizontal_frames ),
+                                   load_frames( data_state::switch_vertical, image_size, assets.to_vertical_frames ) );
+
+    return assets;
+}
+
+void save_cache( const QString& file_name, const QSize& image_size, const decoded_assets& assets )
+{
+    atlas_header header;
+    header.width = static_cast< uint32_t >( image_size.width() );
+    header.height = static_cast< uint32_t >( image_size.height() );
+    header.frame_delay = static_cast< uint32_t >( assets.frame_delay );
+    header.to_horizontal_num = static_cast< uint32_t >( assets.to_horizontal_frames.size() );
+    header.to_vertical_num = static_cast< uint32_t >( assets.to_vertical_frames.size() );
+
+    QSaveFile file{ file_name };
+    if( !file.open( QFile::WriteOnly ) )
+    {
+        qWarning( "Failed to cache assets in %s", qPrintable( file_name ) );
+        return;
+    }
+
+    file.write( reinterpret_cast< const char* >( &header ), sizeof( header ) );
+
+    auto write_image = [ &file, &image_size ]( const QImage& image )
+    {
+        // Rows of 32 bit pixels are never padded
+        for( int row{ 0 }; row < image_size.height(); ++row )
+        {
+            file.write( reinterpret_cast< const char* >( image.constScanLine( row ) ), image_size.width() * 4 );
+        }
+    };
+
+    write_image( assets.lock_locked );
+    write_image( assets.lock_unlocked );
+
+    for( const QImage& frame : assets.to_horizontal_frames )
+    {
+        write_image( frame );
+    }
+
+    for( const QImage& frame : assets.to_vertical_frames )
+    {
+        write_image( frame );
+    }
+
+    if( !file.commit() )
+    {
+        qWarning( "Failed to cache assets in %s", qPrintable( file_name ) );
+    }
+}
+
+void asset_atlas::load( const QSize& image_size, const QString& cache_dir )
+{
+    m_image_size = image_size;
+
+    QString file_name;
+    if( !cache_dir.isEmpty() && QDir{}.mkpath( cache_dir ) )
+    {
+        file_name = QDir{ cache_dir }.filePath( QString{ "atlas_%1x%2_%3.bin" }.arg( image_size.width() )
+                                                                               .arg( image_size.height() )
+                                                                               .arg( get_resources_hash() ) );
+        if( map_cache( file_name ) )
+        {
+            return;
+        }
+    }
+
+    decoded_assets assets{ decode_resources( image_size ) };
+    if( !file_name.isEmpty() )
+    {
+        save_cache( file_name, image_size, assets );
+    }
+
+    m_frame_delay = assets.frame_delay;
+    m_lock_locked = QPixmap::fromImage( assets.lock_locked );
+    m_lock_unlocked = QPixmap::fromImage( assets.lock_unlocked );
+
+    for( const QImage& frame : assets.to_horizontal_frames )
+    {
+        m_to_horizontal_frames.push_back( QPixmap::fromImage( frame ) );
+    }
+
+    for( const QImage& frame : assets.to_vertical_frames )
+    {
+        m_to_vertical_frames.push_back( QPixmap::fromImage( frame ) );
+    }
+}
+
+bool asset_atlas::map_cache( const QString& file_name )
+{
+    m_cache_file.setFileName( file_name );
+    if( !m_cache_file.open( QFile::ReadOnly ) )
+    {
+        return false;
+    }
+
+    qint64 file_size{ m_cache_file.size() };
+    const uchar* data{ file_size >= static_cast< qint64 >( sizeof( atlas_header ) )?
+                            m_cache_file.map( 0, file_size ) : nullptr };
+
+    atlas_header header;
+    if( data )
+    {
+        std::memcpy( &header, data, sizeof( header ) );
+    }
+
+    qint64 image_bytes{ static_cast< qint64 >( m_image_size.width() ) * m_image_size.height() * 4 };
+
+    // Anything unexpected means a foreign or truncated file, it gets rebuilt
+    if( !data ||
+        header.magic != atlas_magic ||
+        header.version != atlas_version ||
+        header.width != static_cast< uint32_t >( m_image_size.width() ) ||
+        header.height != static_cast< uint32_t >( m_image_size.height() ) ||
+        !header.to_horizontal_num || !header.to_vertical_num ||
+        file_size != static_cast< qint64 >( sizeof( header ) ) +
+                     ( 2 + static_cast< qint64 >( header.to_horizontal_num ) + header.to_vertical_num ) * image_bytes )
+    {
+        m_cache_file.close();
+        return false;
+    }
+
+    const uchar* image_data{ data + sizeof( header ) };
+    auto next_image = [ & ]()
+    {
+        QPixmap pixmap{ QPixmap::fromImage( QImage{ image_data,
+                                                    m_image_size.width(),
+                                                    m_image_size.height(),
+                                                    m_image_size.width() * 4,
+                                                    QImage::Format_ARGB32_Premultiplied } ) };
+        image_data += image_bytes;
+        return pixmap;
+    };
+
+    m_frame_delay = static_cast< int >( header.frame_delay );
+    m_lock_locked = next_image();
+    m_lock_unlocked = next_image();
+
+    for( uint32_t frame{ 0 }; frame < header.to_horizontal_num; ++frame )
+    {
+        m_to_horizontal_frames.push_back( next_image() );
+    }
+
+    for( uint32_t frame{ 0 }; frame < header.to_vertical_num; ++frame )
+    {
+        m_to_vertical_frames.push_back( next_image() );
+    }
+
+    return true;
+}
+
+const QPixmap& asset_atlas::get_lock( const data_state& state ) const noexcept
+{
+    return state == data_state::lock_locked? m_lock_locked : m_lock_unlocked;
+}
+
+const QVector< QPixmap >& asset_atlas::get_frames( const data_state& state ) const noexcept
+{
+    return state == data_state::switch_horizontal? m_to_horizontal_frames : m_to_vertical_frames;
+}
+
+int asset_atlas::get_frame_delay() const noexcept
+{
+    return m_frame_delay;
+}
@@ -0,0 +1,41 @@
+#ifndef ASSET_ATLAS_H
+#define ASSET_ATLAS_H
+
+#include <QFile>
+#include <QSize>
+#include <QVector>
+#include <QPixmap>
+
+#include "common.h"
+
+// Lock images and switch animation frames pre-scaled to a single image size.
+// The first start at a size decodes the resources and writes them into one cache file
+// keyed by the size and the resources' hash, later starts map that file instead.
+
+class asset_atlas
+{
+public:
+    // Cache is not used if cache_dir is empty, throws std::runtime_error if the assets can not be loaded
+    void load( const QSize& image_size, const QString& cache_dir );
+
+    const QPixmap& get_lock( const data_state& state ) const noexcept;
+    const QVector< QPixmap >& get_frames( const data_state& state ) const noexcept;
+    int get_frame_delay() const noexcept;
+
+private:
+    bool map_cache( const QString& file_name );
+
+private:
+    QSize m_image_size;
+    int m_frame_delay{ 0 };
+
+    QPixmap m_lock_locked;
+    QPixmap m_lock_unlocked;
+    QVector< QPixmap > m_to_horizontal_frames;
+    QVector< QPixmap > m_to_vertical_frames;
+
+    // Pixmaps are built straight from the mapped cache file
+    QFile m_cache_file;
+};
+
+#endif
@@ -0,0 +1,37 @@
+#-------------------------------------------------
+#
+# Microbenchmarks of the controller and the scores hot paths
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+TARGET = benchmark
+TEMPLATE = app
+
+CONFIG += c++11 console thread
+CONFIG -= app_bundle
+
+include(../engine.pri)
+
+SOURCES += \
+    main.cpp \
+    ../model_controller.cpp \
+    ../board_model.cpp \
+    ../board_snapshot.cpp \
+    ../scores_manager.cpp \
+    ../score_journal.cpp \
+    ../score_stats.cpp \
+    ../tracing.cpp
+
+HEADERS += \
+    ../model_controller.h \
+    ../board_model.h \
+    ../board_snapshot.h \
+    ../scores_manager.h \
+    ../score_journal.h \
+    ../score_stats.h \
+    ../triple_buffer.h \
+    ../tracing.h \
+    ../common.h
@@ -0,0 +1,303 @@
+#include <chrono>
+#include <limits>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include <QDir>
+#include <QTemporaryDir>
+#include <QCoreApplication>
+
+#include "model_controller.h"
+#include "scores_manager.h"
+#include "fast_random.h"
+
+// Times the controller's and the scores manager's hot paths over a sweep of grid sizes
+// and writes the results as JSON
+
+struct benchmark_settings
+{
+    size_t min_grid_size{ 3 };
+    size_t max_grid_size{ 512 };
+    std::chrono::milliseconds min_time{ 100 };
+    std::string file_name;
+};
+
+struct benchmark_result
+{
+    std::string name;
+    size_t grid_size{ 0 };
+    uint64_t iterations{ 0 };
+    double ns_per_op{ 0 };
+};
+
+// Reaches the private steps of a move
+class controller_benchmark
+{
+public:
+    // Worst case, every column gets its lock re-checked
+    static void update_all_locks( model_controller& controller )
+    {
+        controller.m_dirty_columns.clear();
+        for( size_t col{ 0 }; col < controller.m_engine.grid_size(); ++col )
+        {
+            controller.m_dirty_columns.push_back( static_cast< int >( col ) );
+        }
+
+        controller.update_locks();
+    }
+
+    // New games should time fill_random, whatever bank is in the current directory
+    static void disable_bank( model_controller& controller )
+    {
+        controller.m_bank = puzzle_bank{};
+        controller.m_bank_file.close();
+    }
+};
+
+benchmark_settings get_settings( int argc, char** argv )
+{
+    enum args_pos{ min_grid_size_pos = 1,
+                   max_grid_size_pos,
+                   min_time_pos,
+                   file_name_pos };
+
+    benchmark_settings settings;
+
+    if( argc >= min_grid_size_pos + 1 )
+    {
+        int grid_size{ std::stoi( argv[ min_grid_size_pos ] ) };
+        if( grid_size <= 0 )
+        {
+            throw std::invalid_argument{ "Grid size should be positive" };
+        }
+
+        settings.min_grid_size = grid_size;
+    }
+
+    if( argc >= max_grid_size_pos + 1 )
+    {
+        int grid_size{ std::stoi( argv[ max_grid_size_pos ] ) };
+        if( grid_size < static_cast< int >( settings.min_grid_size ) )
+        {
+            throw std::invalid_argument{ "Max grid size should not be less than the min one" };
+        }
+
+        settings.max_grid_size = grid_size;
+    }
+
+    if( argc >= min_time_pos + 1 )
+    {
+        int min_time{ std::stoi( argv[ min_time_pos ] ) };
+        if( min_time <= 0 )
+        {
+            throw std::invalid_argument{ "Min time should be positive" };
+        }
+
+        settings.min_time = std::chrono::milliseconds{ min_time };
+    }
+
+    if( argc >= file_name_pos + 1 )
+    {
+        settings.file_name = argv[ file_name_pos ];
+    }
+
+    return settings;
+}
+
+// Every size with a specialized kernel, then powers of two
+std::vector< size_t > get_grid_sizes( const benchmark_settings& settings )
+{
+    std::vector< size_t > grid_sizes;
+    for( size_t grid_size{ settings.min_grid_size }; grid_size <= settings.max_grid_size; )
+    {
+        grid_sizes.push_back( grid_size );
+
+        if( grid_size < 16 )
+        {
+            ++grid_size;
+        }
+        else
+        {
+            size_t next_size{ 32 };
+            while( next_size <= grid_size )
+            {
+                next_size *= 2;
+            }
+
+            grid_size = next_size;
+        }
+    }
+
+    if( grid_sizes.back() != settings.max_grid_size )
+    {
+        grid_sizes.push_back( settings.max_grid_size );
+    }
+
+    return grid_sizes;
+}
+
+// Runs func in growing batches until they take at least min_time
+template< typename func_type >
+benchmark_result measure( const std::string& name,
+                          size_t grid_size,
+                          const std::chrono::milliseconds& min_time,
+                          func_type func )
+{
+    using clock = std::chrono::steady_clock;
+
+    uint64_t iterations{ 0 };
+    clock::duration elapsed{ 0 };
+
+    for( uint64_t batch{ 1 }; elapsed < min_time; batch *= 2 )
+    {
+        auto start = clock::now();
+        for( uint64_t pos{ 0 }; pos < batch; ++pos )
+        {
+            func();
+        }
+
+        elapsed += clock::now() - start;
+        iterations += batch;
+    }
+
+    benchmark_result result;
+    result.name = name;
+    result.grid_size = grid_size;
+    result.iterations = iterations;
+    result.ns_per_op = std::chrono::duration< double, std::nano >( elapsed ).count() / iterations;
+
+    return result;
+}
+
+void run_grid( size_t grid_size,
+               const benchmark_settings& settings,
+               const QString& scores_dir,
+               std::vector< benchmark_result >& results )
+{
+    static constexpr size_t action_buffer_size{ 16 };
+    static constexpr size_t max_score_records{ 10 };
+    static constexpr int all_animations{ std::numeric_limits< uint16_t >::max() };
+
+    // Without a view every completion belongs to the current move
+    static constexpr quint64 current_generation{ std::numeric_limits< quint64 >::max() };
+
+    board_model model;
+    model_controller controller{ model, grid_size, action_buffer_size, QString{}, difficulty::normal, grid_size };
+    controller_benchmark::disable_bank( controller );
+    xoshiro256 rng{ grid_size };
+
+    // The longest move takes a wave per cell of the distance to the farthest edge
+    auto complete_move = [ &controller, grid_size ]()
+    {
+        for( size_t wave{ 0 }; wave <= grid_size; ++wave )
+        {
+            controller.swap_animation_complete( all_animations, current_generation );
+        }
+    };
+
+    auto click = [ & ]()
+    {
+        int row{ static_cast< int >( rng() % grid_size ) + first_switch_row_pos };
+        int col{ static_cast< int >( rng() % grid_size ) };
+        controller.on_click( model.index( row, col ) );
+        complete_move();
+    };
+
+    results.push_back( measure( "start_new_game", grid_size, settings.min_time, [ & ]()
+    {
+        controller.start_new_game();
+    } ) );
+
+    results.push_back( measure( "click_wave", grid_size, settings.min_time, click ) );
+
+    results.push_back( measure( "update_locks", grid_size, settings.min_time, [ & ]()
+    {
+        controller_benchmark::update_all_locks( controller );
+    } ) );
+
+    // History is full after the clicks above
+    results.push_back( measure( "undo_redo", grid_size, settings.min_time, [ & ]()
+    {
+        controller.undo();
+        complete_move();
+        controller.redo();
+        complete_move();
+    } ) );
+
+    scores_manager manager{ QDir{ scores_dir }.filePath( QString{ "scores_%1" }.arg( grid_size ) ),
+                            max_score_records,
+                            grid_size };
+
+    results.push_back( measure( "on_victory", grid_size, settings.min_time, [ & ]()
+    {
+        manager.on_victory( static_cast< int >( rng() % 1000 ) );
+    } ) );
+}
+
+void write_results( std::ostream& out, const std::vector< benchmark_result >& results )
+{
+    out << "{\"benchmarks\":[";
+
+    for( size_t pos{ 0 }; pos < results.size(); ++pos )
+    {
+        const benchmark_result& result = results[ pos ];
+        out << ( pos? ",\n" : "\n" )
+            << "{\"name\":\"" << result.name << "\""
+            << ",\"grid_size\":" << result.grid_size
+            << ",\"iterations\":" << result.iterations
+            << ",\"ns_per_op\":" << result.ns_per_op << "}";
+    }
+
+    out << "\n]}\n";
+}
+
+int main( int argc, char* argv[] )
+{
+    int return_code{ 0 };
+
+    try
+    {
+        // The scores journal is written by its own thread
+        QCoreApplication app{ argc, argv };
+
+        benchmark_settings settings{ get_settings( argc, argv ) };
+
+        QTemporaryDir scores_dir;
+        if( !scores_dir.isValid() )
+        {
+            throw std::ios_base::failure{ "Failed to create a directory for scores" };
+        }
+
+        std::vector< benchmark_result > results;
+        for( size_t grid_size : get_grid_sizes( settings ) )
+        {
+            std::cerr << "Grid " << grid_size << "x" << grid_size << std::endl;
+            run_grid( grid_size, settings, scores_dir.path(), results );
+        }
+
+        if( settings.file_name.empty() )
+        {
+            write_results( std::cout, results );
+        }
+        else
+        {
+            std::ofstream out{ settings.file_name, std::ios::trunc };
+            write_results( out, results );
+
+            if( !out )
+            {
+                throw std::ios_base::failure{ "Failed to write results" };
+            }
+        }
+    }
+    catch( const std::exception& e )
+    {
+        std::cerr << e.what() << std::endl;
+        return_code = -1;
+    }
+
+    return return_code;
+}
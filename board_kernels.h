@@ -0,0 +1,54 @@
+#ifndef BOARD_KERNELS_H
+#define BOARD_KERNELS_H
+
+#include <cstdint>
+#include <cstddef>
+
+// Calls func( 0 ), ..., func( count - 1 ) with no loop left at run time
+template< size_t count >
+struct unroll
+{
+    template< typename func_type >
+    static void run( const func_type& func )
+    {
+        unroll< count - 1 >::run( func );
+        func( count - 1 );
+    }
+};
+
+template<>
+struct unroll< 0 >
+{
+    template< typename func_type >
+    static void run( const func_type& ){}
+};
+
+// Board operations for a grid size known at compile time: a single word per row,
+// constexpr row mask and every row visited by unrolled code instead of a bounded loop
+
+template< size_t grid_size >
+struct fixed_board_kernel
+{
+    static_assert( grid_size > 0 && grid_size < 64, "Fixed kernels keep a row in one word" );
+
+    static constexpr uint64_t row_mask{ ( uint64_t{ 1 } << grid_size ) - 1 };
+
+    static void click( uint64_t* rows, size_t row, size_t col ) noexcept
+    {
+        uint64_t col_bit{ uint64_t{ 1 } << col };
+        unroll< grid_size >::run( [ rows, col_bit ]( size_t curr_row ){ rows[ curr_row ] ^= col_bit; } );
+
+        // The clicked switch got flipped by the column already
+        rows[ row ] ^= row_mask ^ col_bit;
+    }
+
+    static uint64_t locked_columns( const uint64_t* rows ) noexcept
+    {
+        uint64_t locked{ 0 };
+        unroll< grid_size >::run( [ rows, &locked ]( size_t row ){ locked |= rows[ row ]; } );
+
+        return locked;
+    }
+};
+
+#endif
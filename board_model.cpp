@@ -0,0 +1,106 @@
+#include "board_model.h"
+
+board_model::board_model( QObject* parent ) : QAbstractTableModel( parent ){}
+
+void board_model::resize( size_t grid_size )
+{
+    beginResetModel();
+
+    m_grid_size = grid_size;
+    m_shown_generation = 0;
+
+    board_snapshot empty_board;
+    empty_board.resize( grid_size );
+    m_boards.reset( empty_board );
+
+    endResetModel();
+}
+
+size_t board_model::grid_size() const noexcept
+{
+    return m_grid_size;
+}
+
+int board_model::rowCount( const QModelIndex& parent ) const
+{
+    return parent.isValid()? 0 : static_cast< int >( m_grid_size ) + first_switch_row_pos;
+}
+
+int board_model::columnCount( const QModelIndex& parent ) const
+{
+    return parent.isValid()? 0 : static_cast< int >( m_grid_size );
+}
+
+QVariant board_model::data( const QModelIndex& index, int role ) const
+{
+    if( !index.isValid() )
+    {
+        return QVariant{};
+    }
+    else if( role == animated_role )
+    {
+        return m_boards.front().animated;
+    }
+    else if( role != Qt::UserRole )
+    {
+        return QVariant{};
+    }
+
+    return as_int( state( index.row(), index.column() ) );
+}
+
+data_state board_model::state( int row, int col ) const noexcept
+{
+    return m_boards.front().state( row, col );
+}
+
+uint64_t board_model::generation() const noexcept
+{
+    return m_boards.front().generation;
+}
+
+uint32_t board_model::changed_switches() const noexcept
+{
+    return m_boards.front().changed_switches;
+}
+
+bool board_model::is_animated() const noexcept
+{
+    return m_boards.front().animated;
+}
+
+void board_model::publish( const board_snapshot& board )
+{
+    // Assignment reuses the buffer's storage, so nothing is allocated after the first rounds
+    m_boards.back() = board;
+    m_boards.publish();
+}
+
+void board_model::refresh()
+{
+    if( !m_boards.acquire() )
+    {
+        return;
+    }
+
+    const board_snapshot& board = m_boards.front();
+
+    // Areas of skipped generations are lost, so fall back to the whole board
+    if( board.generation == m_shown_generation + 1 )
+    {
+        if( !board.changed.empty() )
+        {
+            emit dataChanged( index( board.changed.top, board.changed.left ),
+                              index( board.changed.bottom, board.changed.right ),
+                              QVector< int >{} << Qt::UserRole );
+        }
+    }
+    else
+    {
+        emit dataChanged( index( 0, 0 ),
+                          index( rowCount() - 1, columnCount() - 1 ),
+                          QVector< int >{} << Qt::UserRole );
+    }
+
+    m_shown_generation = board.generation;
+}
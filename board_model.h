@@ -0,0 +1,48 @@
+#ifndef BOARD_MODEL_H
+#define BOARD_MODEL_H
+
+#include <QAbstractTableModel>
+
+#include "common.h"
+#include "triple_buffer.h"
+#include "board_snapshot.h"
+
+// Read-only table model over the boards published by the controller.
+// Lives in the GUI thread and only switches to a newer board in refresh(),
+// so a view always renders a single board generation.
+
+// Qt::UserRole holds data_state values, this one whether their changes are animated
+static constexpr int animated_role{ Qt::UserRole + 1 };
+
+class board_model : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit board_model( QObject* parent = nullptr );
+
+    void resize( size_t grid_size );
+    size_t grid_size() const noexcept;
+
+    int rowCount( const QModelIndex& parent = QModelIndex{} ) const override;
+    int columnCount( const QModelIndex& parent = QModelIndex{} ) const override;
+    QVariant data( const QModelIndex& index, int role = Qt::DisplayRole ) const override;
+
+    data_state state( int row, int col ) const noexcept;
+    uint64_t generation() const noexcept;
+    uint32_t changed_switches() const noexcept;
+    bool is_animated() const noexcept;
+
+    // Safe to call from the controller's thread
+    void publish( const board_snapshot& board );
+
+public slots:
+    void refresh();
+
+private:
+    size_t m_grid_size{ 0 };
+    uint64_t m_shown_generation{ 0 };
+    triple_buffer< board_snapshot > m_boards;
+};
+
+#endif
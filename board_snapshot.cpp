@@ -0,0 +1,76 @@
+#include "board_snapshot.h"
+
+#include <algorithm>
+
+static constexpr size_t bits_per_word{ game_engine::bits_per_word };
+
+bool board_area::empty() const noexcept
+{
+    return bottom < top;
+}
+
+void board_area::add( int row, int col ) noexcept
+{
+    if( empty() )
+    {
+        top = bottom = row;
+        left = right = col;
+    }
+    else
+    {
+        top = std::min( top, row );
+        bottom = std::max( bottom, row );
+        left = std::min( left, col );
+        right = std::max( right, col );
+    }
+}
+
+void board_snapshot::resize( size_t grid_size )
+{
+    generation = 0;
+    changed = board_area{};
+    changed_switches = 0;
+    switches.resize( grid_size );
+    locks.assign( switches.words_per_row(), 0 );
+}
+
+size_t board_snapshot::grid_size() const noexcept
+{
+    return switches.grid_size();
+}
+
+data_state board_snapshot::state( int row, int col ) const noexcept
+{
+    if( row == lock_row_pos )
+    {
+        return switches.is_locked( locks, static_cast< size_t >( col ) )?
+                    data_state::lock_locked : data_state::lock_unlocked;
+    }
+
+    return switches.is_vertical( static_cast< size_t >( row - first_switch_row_pos ),
+                                 static_cast< size_t >( col ) )?
+                data_state::switch_vertical : data_state::switch_horizontal;
+}
+
+void board_snapshot::set_state( const data_state& state, int row, int col ) noexcept
+{
+    changed.add( row, col );
+
+    if( row == lock_row_pos )
+    {
+        uint64_t mask{ uint64_t{ 1 } << ( col % bits_per_word ) };
+        uint64_t& word = locks[ static_cast< size_t >( col ) / bits_per_word ];
+        word = state == data_state::lock_locked? word | mask : word & ~mask;
+    }
+    else
+    {
+        if( state != this->state( row, col ) )
+        {
+            ++changed_switches;
+        }
+
+        switches.set_vertical( static_cast< size_t >( row - first_switch_row_pos ),
+                               static_cast< size_t >( col ),
+                               state == data_state::switch_vertical );
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef BOARD_SNAPSHOT_H
+#define BOARD_SNAPSHOT_H
+
+#include <vector>
+
+#include "common.h"
+#include "game_engine.h"
+
+// Bounding rect of the cells changed by one wave
+
+struct board_area
+{
+    int top{ 0 };
+    int left{ 0 };
+    int bottom{ -1 };
+    int right{ -1 };
+
+    bool empty() const noexcept;
+    void add( int row, int col ) noexcept;
+};
+
+// Switches and locks of one board generation, never changed after being published
+
+struct board_snapshot
+{
+    uint64_t generation{ 0 };
+
+    // Cells changed since the previous generation and how many switches among them got turned
+    board_area changed;
+    uint32_t changed_switches{ 0 };
+
+    // Changed switches are shown right away if not set, e.g. after a fast-forward
+    bool animated{ true };
+
+    // Bit is set for vertical switches and locked locks
+    game_engine switches;
+    std::vector< uint64_t > locks;
+
+    void resize( size_t grid_size );
+    size_t grid_size() const noexcept;
+
+    data_state state( int row, int col ) const noexcept;
+    void set_state( const data_state& state, int row, int col ) noexcept;
+};
+
+#endif
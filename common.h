@@ -1,11 +1,39 @@
 #ifndef COMMON_H
 #define COMMON_H
 
+#include <cstdint>
 #include <type_traits>
 
 enum class data_state{ switch_horizontal, switch_vertical, lock_locked, lock_unlocked };
 enum rows_pos{ lock_row_pos, first_switch_row_pos };
 
+// Widgets mode shows every cell through a QLabel index widget,
+// direct mode paints them with the view's painter
+enum class render_mode{ widgets, direct };
+
+// On change mode repaints cells only when the model or a running animation changes them,
+// continuous mode schedules a new paint after every paint and never lets the view idle
+enum class repaint_mode{ on_change, continuous };
+
+// Clicked cell packed into 32 bits, row in the high half and column in the low one
+using packed_action = uint32_t;
+static constexpr uint32_t max_packed_coord{ 0xffff };
+
+constexpr packed_action pack_action( uint32_t row, uint32_t col ) noexcept
+{
+    return row << 16 | col;
+}
+
+constexpr uint32_t get_action_row( packed_action action ) noexcept
+{
+    return action >> 16;
+}
+
+constexpr uint32_t get_action_col( packed_action action ) noexcept
+{
+    return action & max_packed_coord;
+}
+
 template<  typename enum_type, typename int_type >
 enum_type as_enum( int_type value )
 {
@@ -0,0 +1,21 @@
+# Qt-free game rules shared by the game and the headless tools
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+SOURCES += \
+    $$PWD/game_engine.cpp \
+    $$PWD/toggle_rules.cpp \
+    $$PWD/solver.cpp \
+    $$PWD/puzzle_bank.cpp \
+    $$PWD/replay.cpp
+
+HEADERS += \
+    $$PWD/game_engine.h \
+    $$PWD/board_kernels.h \
+    $$PWD/toggle_rules.h \
+    $$PWD/fast_random.h \
+    $$PWD/solver.h \
+    $$PWD/puzzle_bank.h \
+    $$PWD/replay.h \
+    $$PWD/traversible_circular_buffer.h
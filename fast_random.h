@@ -0,0 +1,67 @@
+#ifndef FAST_RANDOM_H
+#define FAST_RANDOM_H
+
+#include <limits>
+#include <cstdint>
+
+// SplitMix64 step, advances the state and returns the next output
+inline uint64_t splitmix64( uint64_t& state ) noexcept
+{
+    uint64_t result{ state += 0x9e3779b97f4a7c15 };
+    result = ( result ^ ( result >> 30 ) ) * 0xbf58476d1ce4e5b9;
+    result = ( result ^ ( result >> 27 ) ) * 0x94d049bb133111eb;
+
+    return result ^ ( result >> 31 );
+}
+
+// xoshiro256** seeded through SplitMix64: 64 bits per draw and the same sequence
+// for the same seed on every platform, unlike the standard distributions
+class xoshiro256
+{
+public:
+    using result_type = uint64_t;
+
+    explicit xoshiro256( uint64_t seed ) noexcept
+    {
+        for( uint64_t& word : m_state )
+        {
+            word = splitmix64( seed );
+        }
+    }
+
+    static constexpr result_type min() noexcept
+    {
+        return 0;
+    }
+
+    static constexpr result_type max() noexcept
+    {
+        return std::numeric_limits< result_type >::max();
+    }
+
+    result_type operator()() noexcept
+    {
+        uint64_t result{ rotl( m_state[ 1 ] * 5, 7 ) * 9 };
+        uint64_t shifted{ m_state[ 1 ] << 17 };
+
+        m_state[ 2 ] ^= m_state[ 0 ];
+        m_state[ 3 ] ^= m_state[ 1 ];
+        m_state[ 1 ] ^= m_state[ 2 ];
+        m_state[ 0 ] ^= m_state[ 3 ];
+        m_state[ 2 ] ^= shifted;
+        m_state[ 3 ] = rotl( m_state[ 3 ], 45 );
+
+        return result;
+    }
+
+private:
+    static uint64_t rotl( uint64_t value, int shift ) noexcept
+    {
+        return ( value << shift ) | ( value >> ( 64 - shift ) );
+    }
+
+private:
+    uint64_t m_state[ 4 ];
+};
+
+#endif
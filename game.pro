@@ -0,0 +1,57 @@
+#-------------------------------------------------
+#
+# Project created by QtCreator 2018-02-17T20:33:17
+#
+#-------------------------------------------------
+
+QT       += core gui
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = LocksGame
+TEMPLATE = app
+
+CONFIG += c++11
+
+# The following define makes your compiler emit warnings if you use
+# any feature of Qt which has been marked as deprecated (the exact warnings
+# depend on your compiler). Please consult the documentation of the
+# deprecated API in order to know how to port your code away from it.
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# You can also make your code fail to compile if you use deprecated APIs.
+# In order to do so, uncomment the following line.
+# You can also select to disable deprecated APIs only up to a certain version of Qt.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+
+SOURCES += \
+    main.cpp \
+    mainwindow.cpp \
+    scores_manager.cpp \
+    score_journal.cpp \
+    score_stats.cpp \
+    graphics_delegate.cpp \
+    model_controller.cpp \
+    board_model.cpp \
+    board_snapshot.cpp \
+    asset_atlas.cpp \
+    tracing.cpp
+
+HEADERS += \
+    mainwindow.h \
+    scores_manager.h \
+    score_journal.h \
+    score_stats.h \
+    graphics_delegate.h \
+    model_controller.h \
+    board_model.h \
+    board_snapshot.h \
+    triple_buffer.h \
+    tracing.h \
+    asset_atlas.h \
+    common.h
+
+include(engine.pri)
+
+RESOURCES += resources.qrc
@@ -0,0 +1,312 @@
+#include "game_engine.h"
+
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+#include "board_kernels.h"
+
+constexpr size_t game_engine::bits_per_word;
+
+// Grid sizes with compile-time kernels
+static constexpr size_t min_fixed_grid_size{ 3 };
+static constexpr size_t max_fixed_grid_size{ 16 };
+
+game_engine::game_engine( size_t grid_size, const toggle_rule& rule ) :
+    m_rule{ rule }
+{
+    resize( grid_size );
+}
+
+void game_engine::resize( size_t grid_size )
+{
+    if( grid_size <= 0 )
+    {
+        throw std::invalid_argument{ "Grid size should be positive" };
+    }
+
+    m_grid_size = grid_size;
+    m_words_per_row = ( grid_size + bits_per_word - 1 ) / bits_per_word;
+    m_switches.assign( m_grid_size * m_words_per_row, 0 );
+
+    m_row_mask.assign( m_words_per_row, ~uint64_t{ 0 } );
+    if( grid_size % bits_per_word )
+    {
+        m_row_mask.back() = ( uint64_t{ 1 } << ( grid_size % bits_per_word ) ) - 1;
+    }
+
+    m_column_masks.resize( m_grid_size );
+    for( size_t col{ 0 }; col < m_grid_size; ++col )
+    {
+        m_column_masks[ col ] = { col / bits_per_word, uint64_t{ 1 } << ( col % bits_per_word ) };
+    }
+
+    m_kernel = get_kernel( grid_size, m_rule );
+}
+
+struct game_engine::rule_kernel_maker
+{
+    using result_type = std::pair< click_func, toggled_cells_func >;
+
+    template< typename rule_type >
+    static result_type make() noexcept
+    {
+        return { &click_rule< rule_type >, &toggled_cells_rule< rule_type > };
+    }
+};
+
+game_engine::kernel game_engine::get_kernel( size_t grid_size, const toggle_rule& rule ) noexcept
+{
+    static const kernel fixed_kernels[]{ get_fixed_kernel< 3 >(),
+                                         get_fixed_kernel< 4 >(),
+                                         get_fixed_kernel< 5 >(),
+                                         get_fixed_kernel< 6 >(),
+                                         get_fixed_kernel< 7 >(),
+                                         get_fixed_kernel< 8 >(),
+                                         get_fixed_kernel< 9 >(),
+                                         get_fixed_kernel< 10 >(),
+                                         get_fixed_kernel< 11 >(),
+                                         get_fixed_kernel< 12 >(),
+                                         get_fixed_kernel< 13 >(),
+                                         get_fixed_kernel< 14 >(),
+                                         get_fixed_kernel< 15 >(),
+                                         get_fixed_kernel< 16 >() };
+
+    static_assert( sizeof( fixed_kernels ) / sizeof( kernel ) == max_fixed_grid_size - min_fixed_grid_size + 1,
+                   "Every fixed grid size needs a kernel" );
+
+    kernel selected{ &click_generic, &locked_columns_generic, &is_solved_generic, &toggled_cells_rule< cross_rule > };
+    if( grid_size >= min_fixed_grid_size && grid_size <= max_fixed_grid_size )
+    {
+        selected = fixed_kernels[ grid_size - min_fixed_grid_size ];
+    }
+
+    // Cross clicks stay whole-word row and column flips
+    if( rule != toggle_rule::cross )
+    {
+        rule_kernel_maker::result_type rule_kernel{ make_for_rule< rule_kernel_maker >( rule ) };
+        selected.click = rule_kernel.first;
+        selected.toggled_cells = rule_kernel.second;
+    }
+
+    return selected;
+}
+
+template< size_t fixed_grid_size >
+game_engine::kernel game_engine::get_fixed_kernel() noexcept
+{
+    return { &click_fixed< fixed_grid_size >,
+             &locked_columns_fixed< fixed_grid_size >,
+             &is_solved_fixed< fixed_grid_size >,
+             &toggled_cells_rule< cross_rule > };
+}
+
+template< size_t fixed_grid_size >
+void game_engine::click_fixed( game_engine& engine, size_t row, size_t col )
+{
+    fixed_board_kernel< fixed_grid_size >::click( engine.m_switches.data(), row, col );
+}
+
+template< size_t fixed_grid_size >
+void game_engine::locked_columns_fixed( const game_engine& engine, std::vector< uint64_t >& locked )
+{
+    locked.assign( 1, fixed_board_kernel< fixed_grid_size >::locked_columns( engine.m_switches.data() ) );
+}
+
+template< size_t fixed_grid_size >
+bool game_engine::is_solved_fixed( const game_engine& engine )
+{
+    return !fixed_board_kernel< fixed_grid_size >::locked_columns( engine.m_switches.data() );
+}
+
+template< typename rule_type >
+void game_engine::click_rule( game_engine& engine, size_t row, size_t col )
+{
+    rule_type::for_each_toggled( engine.m_grid_size, row, col, [ &engine ]( size_t curr_row, size_t curr_col, size_t )
+    {
+        engine.swap( curr_row, curr_col );
+    } );
+}
+
+template< typename rule_type >
+void game_engine::toggled_cells_rule( const game_engine& engine,
+                                      size_t row,
+                                      size_t col,
+                                      std::vector< toggled_cell >& cells )
+{
+    cells.clear();
+    rule_type::for_each_toggled( engine.m_grid_size, row, col, [ &cells ]( size_t curr_row, size_t curr_col, size_t distance )
+    {
+        cells.push_back( { static_cast< uint32_t >( curr_row ),
+                           static_cast< uint32_t >( curr_col ),
+                           static_cast< uint32_t >( distance ) } );
+    } );
+}
+
+void game_engine::clear() noexcept
+{
+    std::fill( m_switches.begin(), m_switches.end(), 0 );
+}
+
+size_t game_engine::grid_size() const noexcept
+{
+    return m_grid_size;
+}
+
+toggle_rule game_engine::rule() const noexcept
+{
+    return m_rule;
+}
+
+size_t game_engine::words_per_row() const noexcept
+{
+    return m_words_per_row;
+}
+
+bool game_engine::is_vertical( size_t row, size_t col ) const noexcept
+{
+    const column_mask& mask = m_column_masks[ col ];
+    return m_switches[ row * m_words_per_row + mask.word ] & mask.bit;
+}
+
+void game_engine::set_vertical( size_t row, size_t col, bool vertical ) noexcept
+{
+    const column_mask& mask = m_column_masks[ col ];
+    uint64_t& word = m_switches[ row * m_words_per_row + mask.word ];
+    word = vertical? word | mask.bit : word & ~mask.bit;
+}
+
+void game_engine::swap( size_t row, size_t col ) noexcept
+{
+    const column_mask& mask = m_column_masks[ col ];
+    m_switches[ row * m_words_per_row + mask.word ] ^= mask.bit;
+}
+
+void game_engine::click( size_t row, size_t col ) noexcept
+{
+    m_kernel.click( *this, row, col );
+}
+
+void game_engine::toggled_cells( size_t row, size_t col, std::vector< toggled_cell >& cells ) const
+{
+    m_kernel.toggled_cells( *this, row, col, cells );
+}
+
+void game_engine::click_generic( game_engine& engine, size_t row, size_t col )
+{
+    const column_mask& mask = engine.m_column_masks[ col ];
+    uint64_t* column_word{ engine.m_switches.data() + mask.word };
+
+    for( size_t curr_row{ 0 }; curr_row < engine.m_grid_size; ++curr_row )
+    {
+        column_word[ curr_row * engine.m_words_per_row ] ^= mask.bit;
+    }
+
+    // Plain word loop, vectorized by the compiler. The clicked switch got flipped
+    // by both the column and the row, so it is flipped once more
+    uint64_t* row_words{ engine.row_data( row ) };
+    const uint64_t* row_mask{ engine.m_row_mask.data() };
+    for( size_t word{ 0 }; word < engine.m_words_per_row; ++word )
+    {
+        row_words[ word ] ^= row_mask[ word ];
+    }
+
+    row_words[ mask.word ] ^= mask.bit;
+}
+
+void game_engine::locked_columns( std::vector< uint64_t >& locked ) const
+{
+    m_kernel.locked_columns( *this, locked );
+}
+
+void game_engine::locked_columns_generic( const game_engine& engine, std::vector< uint64_t >& locked )
+{
+    locked.assign( engine.m_words_per_row, 0 );
+
+    for( size_t row{ 0 }; row < engine.m_grid_size; ++row )
+    {
+        const uint64_t* row_words{ engine.row_data( row ) };
+        for( size_t word{ 0 }; word < engine.m_words_per_row; ++word )
+        {
+            locked[ word ] |= row_words[ word ];
+        }
+    }
+}
+
+bool game_engine::is_locked( const std::vector< uint64_t >& locked, size_t col ) const noexcept
+{
+    const column_mask& mask = m_column_masks[ col ];
+    return locked[ mask.word ] & mask.bit;
+}
+
+bool game_engine::is_solved() const noexcept
+{
+    return m_kernel.is_solved( *this );
+}
+
+bool game_engine::is_solved_generic( const game_engine& engine )
+{
+    for( uint64_t word : engine.m_switches )
+    {
+        if( word )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+const uint64_t* game_engine::row_data( size_t row ) const noexcept
+{
+    return m_switches.data() + row * m_words_per_row;
+}
+
+uint64_t* game_engine::row_data( size_t row ) noexcept
+{
+    return m_switches.data() + row * m_words_per_row;
+}
+
+uint32_t calc_score( size_t grid_size, uint32_t total_actions ) noexcept
+{
+    // A board that was solved from the start takes no actions at all
+    return total_actions? double( grid_size * 100 ) / total_actions : grid_size * 100;
+}
+
+void fill_random( game_engine& engine, xoshiro256& rng ) noexcept
+{
+    if( engine.rule() != toggle_rule::cross )
+    {
+        engine.clear();
+        for( size_t row{ 0 }; row < engine.grid_size(); ++row )
+        {
+            for( size_t col{ 0 }; col < engine.grid_size(); col += game_engine::bits_per_word )
+            {
+                uint64_t clicks{ rng() };
+                for( size_t bit{ 0 }; bit < game_engine::bits_per_word && col + bit < engine.grid_size(); ++bit )
+                {
+                    if( clicks & ( uint64_t{ 1 } << bit ) )
+                    {
+                        engine.click( row, col + bit );
+                    }
+                }
+            }
+        }
+
+        return;
+    }
+
+    size_t tail_bits{ engine.grid_size() % game_engine::bits_per_word };
+    uint64_t last_word_mask{ tail_bits? ( uint64_t{ 1 } << tail_bits ) - 1 : ~uint64_t{ 0 } };
+
+    for( size_t row{ 0 }; row < engine.grid_size(); ++row )
+    {
+        uint64_t* row_words{ engine.row_data( row ) };
+        for( size_t word{ 0 }; word < engine.words_per_row(); ++word )
+        {
+            row_words[ word ] = rng();
+        }
+
+        row_words[ engine.words_per_row() - 1 ] &= last_word_mask;
+    }
+}
@@ -0,0 +1,125 @@
+#ifndef GAME_ENGINE_H
+#define GAME_ENGINE_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "fast_random.h"
+#include "toggle_rules.h"
+
+// Headless game rules: switches are stored as 64-bit words per row,
+// a set bit is a vertical switch. Rows and columns are zero-based switch coordinates.
+// The rule of a click is fixed at construction, cross unless told otherwise.
+
+class game_engine
+{
+public:
+    static constexpr size_t bits_per_word{ 64 };
+
+    game_engine() = default;
+    explicit game_engine( size_t grid_size, const toggle_rule& rule = toggle_rule::cross );
+
+    void resize( size_t grid_size );
+    void clear() noexcept;
+
+    size_t grid_size() const noexcept;
+    toggle_rule rule() const noexcept;
+    size_t words_per_row() const noexcept;
+
+    bool is_vertical( size_t row, size_t col ) const noexcept;
+    void set_vertical( size_t row, size_t col, bool vertical ) noexcept;
+
+    // Flips a single switch
+    void swap( size_t row, size_t col ) noexcept;
+
+    // Flips the switches of the rule around a switch
+    void click( size_t row, size_t col ) noexcept;
+
+    // Switches flipped by a click, the clicked one first and the rest by distance
+    void toggled_cells( size_t row, size_t col, std::vector< toggled_cell >& cells ) const;
+
+    // OR of all rows, a set bit means the column still has a vertical switch
+    void locked_columns( std::vector< uint64_t >& locked ) const;
+    bool is_locked( const std::vector< uint64_t >& locked, size_t col ) const noexcept;
+    bool is_solved() const noexcept;
+
+    const uint64_t* row_data( size_t row ) const noexcept;
+    uint64_t* row_data( size_t row ) noexcept;
+
+private:
+    // Size-specialized implementations are picked in resize(), the generic ones cover other sizes.
+    // Rules other than the cross replace the click, locks do not depend on the rule
+    using click_func = void ( * )( game_engine& engine, size_t row, size_t col );
+    using locked_columns_func = void ( * )( const game_engine& engine, std::vector< uint64_t >& locked );
+    using is_solved_func = bool ( * )( const game_engine& engine );
+    using toggled_cells_func = void ( * )( const game_engine& engine,
+                                           size_t row,
+                                           size_t col,
+                                           std::vector< toggled_cell >& cells );
+
+    struct kernel
+    {
+        click_func click;
+        locked_columns_func locked_columns;
+        is_solved_func is_solved;
+        toggled_cells_func toggled_cells;
+    };
+
+    struct rule_kernel_maker;
+
+    static kernel get_kernel( size_t grid_size, const toggle_rule& rule ) noexcept;
+
+    template< size_t fixed_grid_size >
+    static kernel get_fixed_kernel() noexcept;
+
+    static void click_generic( game_engine& engine, size_t row, size_t col );
+    static void locked_columns_generic( const game_engine& engine, std::vector< uint64_t >& locked );
+    static bool is_solved_generic( const game_engine& engine );
+
+    template< size_t fixed_grid_size >
+    static void click_fixed( game_engine& engine, size_t row, size_t col );
+
+    template< size_t fixed_grid_size >
+    static void locked_columns_fixed( const game_engine& engine, std::vector< uint64_t >& locked );
+
+    template< size_t fixed_grid_size >
+    static bool is_solved_fixed( const game_engine& engine );
+
+    template< typename rule_type >
+    static void click_rule( game_engine& engine, size_t row, size_t col );
+
+    template< typename rule_type >
+    static void toggled_cells_rule( const game_engine& engine,
+                                    size_t row,
+                                    size_t col,
+                                    std::vector< toggled_cell >& cells );
+
+private:
+    // Word and bit flipped in every row by a click in the column
+    struct column_mask
+    {
+        size_t word;
+        uint64_t bit;
+    };
+
+    size_t m_grid_size{ 0 };
+    size_t m_words_per_row{ 0 };
+    toggle_rule m_rule{ toggle_rule::cross };
+
+    std::vector< uint64_t > m_switches;
+
+    // Toggle masks shared by all cells: the whole row and a bit per column
+    std::vector< uint64_t > m_row_mask;
+    std::vector< column_mask > m_column_masks;
+
+    kernel m_kernel{ get_kernel( 0, toggle_rule::cross ) };
+};
+
+uint32_t calc_score( size_t grid_size, uint32_t total_actions ) noexcept;
+
+// Coin flip for every switch, a whole row word per draw. Under other rules than the cross
+// such a board may have no solution, so the flips are clicks on a solved board instead
+void fill_random( game_engine& engine, xoshiro256& rng ) noexcept;
+
+#endif
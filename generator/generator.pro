@@ -0,0 +1,18 @@
+#-------------------------------------------------
+#
+# Offline generator of puzzle banks
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = generator
+TEMPLATE = app
+
+CONFIG += c++11 console thread
+CONFIG -= app_bundle
+
+include(../engine.pri)
+
+SOURCES += \
+    main.cpp
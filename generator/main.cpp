@@ -0,0 +1,202 @@
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <numeric>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+#include "game_engine.h"
+#include "solver.h"
+#include "puzzle_bank.h"
+
+// Generates puzzles on all cores, sorts them by minimum solution length and writes a bank
+
+struct generator_settings
+{
+    size_t grid_size{ 3 };
+    size_t puzzles{ 100000 };
+    size_t threads{ std::max( 1u, std::thread::hardware_concurrency() ) };
+    uint64_t seed{ 0 };
+    std::string file_name;
+};
+
+generator_settings get_settings( int argc, char** argv )
+{
+    enum args_pos{ grid_size_pos = 1,
+                   puzzles_pos,
+                   threads_pos,
+                   seed_pos,
+                   file_name_pos };
+
+    generator_settings settings;
+
+    if( argc >= grid_size_pos + 1 )
+    {
+        int grid_size{ std::stoi( argv[ grid_size_pos ] ) };
+        if( grid_size <= 0 )
+        {
+            throw std::invalid_argument{ "Grid size should be positive" };
+        }
+
+        settings.grid_size = grid_size;
+    }
+
+    if( argc >= puzzles_pos + 1 )
+    {
+        long long puzzles{ std::stoll( argv[ puzzles_pos ] ) };
+        if( puzzles <= 0 )
+        {
+            throw std::invalid_argument{ "Puzzles number should be positive" };
+        }
+
+        settings.puzzles = puzzles;
+    }
+
+    if( argc >= threads_pos + 1 )
+    {
+        int threads{ std::stoi( argv[ threads_pos ] ) };
+        if( threads <= 0 )
+        {
+            throw std::invalid_argument{ "Threads number should be positive" };
+        }
+
+        settings.threads = threads;
+    }
+
+    if( argc >= seed_pos + 1 )
+    {
+        settings.seed = std::stoull( argv[ seed_pos ] );
+    }
+
+    settings.file_name = argc >= file_name_pos + 1? argv[ file_name_pos ] :
+                                                    get_bank_file_name( settings.grid_size );
+    if( settings.file_name.empty() )
+    {
+        throw std::invalid_argument{ "Bank file name should not be empty" };
+    }
+
+    return settings;
+}
+
+// Boards are built from a random set of clicks, so every one of them is solvable.
+// The number of clicks is uniform to cover all difficulties, for even grids it is
+// the exact solution length, for odd ones the solver finds a shorter one if it exists.
+void generate_puzzles( const generator_settings& settings,
+                       std::atomic< uint64_t >& next_puzzle,
+                       std::vector< uint32_t >& lengths,
+                       std::vector< uint64_t >& boards )
+{
+    size_t cells_num{ settings.grid_size * settings.grid_size };
+
+    game_engine engine{ settings.grid_size };
+    solver puzzle_solver{ settings.grid_size };
+    size_t board_words{ settings.grid_size * engine.words_per_row() };
+
+    std::vector< uint32_t > cells( cells_num );
+
+    for( uint64_t puzzle{ next_puzzle++ }; puzzle < settings.puzzles; puzzle = next_puzzle++ )
+    {
+        // Every puzzle has its own seed, so the bank does not depend on the threads number
+        xoshiro256 rng{ settings.seed + puzzle };
+
+        do
+        {
+            engine.clear();
+            std::iota( cells.begin(), cells.end(), 0 );
+
+            // Raw draws rather than standard distributions keep the bank the same on every platform
+            size_t clicks{ 1 + rng() % cells_num };
+            for( size_t click{ 0 }; click < clicks; ++click )
+            {
+                std::swap( cells[ click ], cells[ click + rng() % ( cells_num - click ) ] );
+                engine.click( cells[ click ] / settings.grid_size, cells[ click ] % settings.grid_size );
+            }
+
+            puzzle_solver.reset( [ &engine ]( size_t row, size_t col ){ return engine.is_vertical( row, col ); } );
+        }
+        while( !puzzle_solver.solution_size() ); // Odd grids may cancel the clicks out
+
+        lengths[ puzzle ] = static_cast< uint32_t >( puzzle_solver.solution_size() );
+        std::copy( engine.row_data( 0 ), engine.row_data( 0 ) + board_words, boards.begin() + puzzle * board_words );
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    int return_code{ 0 };
+
+    try
+    {
+        generator_settings settings{ get_settings( argc, argv ) };
+
+        size_t board_words{ settings.grid_size * game_engine{ settings.grid_size }.words_per_row() };
+        std::vector< uint32_t > lengths( settings.puzzles );
+        std::vector< uint64_t > boards( settings.puzzles * board_words );
+
+        std::atomic< uint64_t > next_puzzle{ 0 };
+        std::vector< std::thread > threads;
+
+        auto start = std::chrono::steady_clock::now();
+
+        for( size_t thread{ 0 }; thread < settings.threads; ++thread )
+        {
+            threads.emplace_back( generate_puzzles,
+                                  std::cref( settings ),
+                                  std::ref( next_puzzle ),
+                                  std::ref( lengths ),
+                                  std::ref( boards ) );
+        }
+
+        for( auto& thread : threads )
+        {
+            thread.join();
+        }
+
+        // Sort by solution length, so every length and difficulty is a range of the bank
+        std::vector< size_t > order( settings.puzzles );
+        std::iota( order.begin(), order.end(), 0 );
+        std::stable_sort( order.begin(), order.end(), [ &lengths ]( size_t left, size_t right )
+        {
+            return lengths[ left ] < lengths[ right ];
+        } );
+
+        std::vector< uint32_t > sorted_lengths( settings.puzzles );
+        std::vector< uint64_t > sorted_boards( boards.size() );
+        for( size_t pos{ 0 }; pos < order.size(); ++pos )
+        {
+            sorted_lengths[ pos ] = lengths[ order[ pos ] ];
+            std::copy( boards.begin() + order[ pos ] * board_words,
+                       boards.begin() + ( order[ pos ] + 1 ) * board_words,
+                       sorted_boards.begin() + pos * board_words );
+        }
+
+        std::ofstream out{ settings.file_name, std::ios::binary | std::ios::trunc };
+        write_puzzle_bank( out, settings.grid_size, sorted_lengths, sorted_boards );
+
+        double seconds{ std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count() };
+
+        std::cout << "Puzzles: " << settings.puzzles << " in " << seconds << " s, "
+                  << settings.puzzles / seconds << " puzzles/sec" << std::endl;
+
+        const char* level_names[]{ "easy", "normal", "hard" };
+        for( size_t level{ 0 }; level < difficulty_levels; ++level )
+        {
+            size_t first{ settings.puzzles * level / difficulty_levels };
+            size_t last{ std::max( first + 1, settings.puzzles * ( level + 1 ) / difficulty_levels ) };
+            std::cout << level_names[ level ] << ": " << sorted_lengths[ first ]
+                      << "-" << sorted_lengths[ last - 1 ] << " clicks" << std::endl;
+        }
+
+        std::cout << "Written to " << settings.file_name << std::endl;
+    }
+    catch( const std::exception& e )
+    {
+        std::cerr << e.what() << std::endl;
+        return_code = -1;
+    }
+
+    return return_code;
+}
@@ -1,31 +1,31 @@
 #include "graphics_delegate.h"
+#include "board_model.h"
+#include "tracing.h"
 
-#include <QLabel>
-
-static constexpr auto img_name_lock_locked = "lock_locked.png";
-static constexpr auto img_name_lock_unlocked = "lock_unlocked.png";
-static constexpr auto img_name_horizontal_vertical_anim = "horizontal_vertical.gif";
-static constexpr auto img_name_vertical_horizontal_anim = "vertical_horizontal.gif";
+#include <algorithm>
+#include <stdexcept>
 
-QString get_image_name( const data_state& state )
-{
-    QString img_name;
+#include <QLabel>
+#include <QPainter>
+#include <QScrollBar>
+#include <QStandardPaths>
 
-    switch( state )
-    {
-    case data_state::lock_locked: img_name = img_name_lock_locked; break;
-    case data_state::lock_unlocked: img_name = img_name_lock_unlocked; break;
-    case data_state::switch_horizontal: img_name = img_name_vertical_horizontal_anim; break;
-    case data_state::switch_vertical: img_name = img_name_horizontal_vertical_anim; break;
-    }
+// Shown state of a cell that has not been painted yet
+static constexpr uint8_t state_not_shown{ 0xff };
 
-    return QString( ":/graphics/%1" ).arg( img_name );
-}
+// Cells beyond the viewport keeping their render state, so short scrolls do not drop it
+static constexpr int hidden_cells_margin{ 2 };
 
-graphics_delegate::graphics_delegate( const QSize& image_size, QAbstractItemView& view, QObject* parent )
+graphics_delegate::graphics_delegate( const QSize& image_size,
+                                      const render_mode& mode,
+                                      const repaint_mode& repaint,
+                                      QAbstractItemView& view,
+                                      QObject* parent )
   : QStyledItemDelegate( parent ),
     m_view( view ),
-    m_image_size( image_size )
+    m_image_size( image_size ),
+    m_mode( mode ),
+    m_repaint( repaint )
 {
     init();
 }
@@ -34,40 +34,100 @@ void graphics_delegate::paint( QPainter * painter,
                            const QStyleOptionViewItem & option,
                            const QModelIndex & index ) const
 {
+    TRACE_SCOPE( "paint" );
+    ++m_paints_count;
+
     QStyledItemDelegate::paint( painter, option, index );
 
     auto curr_state = as_enum< data_state >( index.data( Qt::UserRole ).toInt() );
+
+    if( m_mode == render_mode::direct )
+    {
+        paint_direct( painter, option, index, curr_state );
+    }
+    else
+    {
+        paint_widget( index, curr_state );
+    }
+
+    if( !m_first_frame_painted )
+    {
+        m_first_frame_painted = true;
+        emit first_frame_painted();
+    }
+
+    if( m_repaint == repaint_mode::continuous )
+    {
+        m_view.update( index );
+    }
+}
+
+void graphics_delegate::paint_widget( const QModelIndex& index, const data_state& state ) const
+{
     QObject* index_widget{ m_view.indexWidget( index ) };
     QLabel* label{ qobject_cast< QLabel* >( index_widget ) };
+    cell_slot& slot = get_slot( get_cell_pos( index ) );
     if( !label )
     {
+        // Zoom changes cell sizes, the view keeps the label as large as its cell
         label = new QLabel{};
+        label->setScaledContents( true );
         m_view.setIndexWidget( index, label );
-        label->setFixedSize( m_image_size );
     }
 
     if( index.row() == lock_row_pos )
     {
-        const QPixmap& required_pixmap = m_lock_pixmaps[ curr_state ];
+        // Locks keep a slot only for their label to be recycled
+        slot.shown_state = as_int( state );
+
+        const QPixmap& required_pixmap = m_atlas.get_lock( state );
         if( label->pixmap() != &required_pixmap )
         {
             label->setPixmap( required_pixmap );
         }
     }
-    else
+    else if( slot.shown_state != as_int( state ) )
     {
-        QMovie* required_movie{ curr_state == data_state::switch_horizontal?
-                        m_switch_movies[ index ].first : m_switch_movies[ index ].second };
+        update_cell( slot, state, index.data( animated_role ).toBool() );
+        label->setPixmap( get_frames( slot.shown_state )[ slot.frame_pos ] );
+    }
+}
 
-        if( label->movie() != required_movie )
+void graphics_delegate::paint_direct( QPainter* painter,
+                                      const QStyleOptionViewItem& option,
+                                      const QModelIndex& index,
+                                      const data_state& state ) const
+{
+    // Pixmaps are scaled only while the board is zoomed
+    if( index.row() == lock_row_pos )
+    {
+        painter->drawPixmap( option.rect, m_atlas.get_lock( state ) );
+    }
+    else
+    {
+        cell_slot& slot = get_slot( get_cell_pos( index ) );
+        if( slot.shown_state != as_int( state ) )
         {
-            required_movie->jumpToFrame( 0 );
-            label->setMovie( required_movie );
-            required_movie->start();
+            update_cell( slot, state, index.data( animated_role ).toBool() );
         }
+
+        painter->drawPixmap( option.rect, get_frames( slot.shown_state )[ slot.frame_pos ] );
     }
+}
 
-    m_view.update( index );
+uint64_t graphics_delegate::get_paints_count() const noexcept
+{
+    return m_paints_count;
+}
+
+void graphics_delegate::set_animation_speed( double speed )
+{
+    if( speed <= 0 )
+    {
+        throw std::invalid_argument{ "Animation speed should be positive" };
+    }
+
+    m_clock.setInterval( std::max( 1, static_cast< int >( m_frame_delay / speed ) ) );
 }
 
 QSize graphics_delegate::sizeHint( const QStyleOptionViewItem&, const QModelIndex& ) const
@@ -75,32 +135,313 @@ QSize graphics_delegate::sizeHint( const QStyleOptionViewItem&, const QModelInde
     return m_image_size;
 }
 
+void graphics_delegate::advance_animations()
+{
+    int completed{ 0 };
+    uint64_t completed_generation{ 0 };
+
+    for( size_t running_pos{ 0 }; running_pos < m_running_slots.size(); )
+    {
+        cell_slot& slot = m_slots[ m_running_slots[ running_pos ] ];
+        const QVector< QPixmap >& frames = get_frames( slot.shown_state );
+
+        if( slot.frame_pos + 1 < frames.size() )
+        {
+            uint16_t frame_pos{ ++slot.frame_pos };
+            QModelIndex index{ get_cell_index( slot.cell_pos ) };
+
+            if( m_mode == render_mode::direct )
+            {
+                m_view.update( index );
+            }
+            else if( QLabel* label = qobject_cast< QLabel* >( m_view.indexWidget( index ) ) )
+            {
+                label->setPixmap( frames[ frame_pos ] );
+            }
+
+            ++running_pos;
+        }
+        else
+        {
+            // Last frame has been shown long enough
+            slot.is_running = false;
+            m_running_slots[ running_pos ] = m_running_slots.back();
+            m_running_slots.pop_back();
+
+            // Animations left over from an earlier move are reported apart
+            if( completed && slot.generation != completed_generation )
+            {
+                emit animation_completed( completed, completed_generation );
+                completed = 0;
+            }
+
+            completed_generation = slot.generation;
+            ++completed;
+        }
+    }
+
+    if( m_running_slots.empty() )
+    {
+        m_clock.stop();
+    }
+
+    if( completed )
+    {
+        emit animation_completed( completed, completed_generation );
+    }
+}
+
 void graphics_delegate::init()
 {
-    m_lock_pixmaps.insert( data_state::lock_locked,
-                           QPixmap::fromImage( QImage{ get_image_name( data_state::lock_locked ) } )
-                                           .scaled( m_image_size ) );
+    m_atlas.load( m_image_size, QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) );
+    int frame_delay{ m_atlas.get_frame_delay() };
 
-    m_lock_pixmaps.insert( data_state::lock_unlocked,
-                           QPixmap::fromImage( QImage{ get_image_name( data_state::lock_unlocked ) } )
-                                           .scaled( m_image_size ) );
+    m_columns = m_view.model()->columnCount();
 
+    m_frame_delay = frame_delay;
+    m_clock.setInterval( frame_delay );
+    connect( &m_clock, SIGNAL( timeout() ), this, SLOT( advance_animations() ) );
+
+    // Runs before the view gets to paint the changed cells
+    connect( m_view.model(),
+             SIGNAL( dataChanged( const QModelIndex&, const QModelIndex&, const QVector< int >& ) ),
+             this,
+             SLOT( complete_hidden_changes( const QModelIndex&, const QModelIndex& ) ) );
+
+    // Ranges change on resizing and zooming, values on scrolling
+    for( QScrollBar* scroll_bar : { m_view.horizontalScrollBar(), m_view.verticalScrollBar() } )
+    {
+        connect( scroll_bar, SIGNAL( valueChanged( int ) ), this, SLOT( recycle_hidden_cells() ) );
+        connect( scroll_bar, SIGNAL( rangeChanged( int, int ) ), this, SLOT( recycle_hidden_cells() ) );
+    }
+}
+
+board_area graphics_delegate::get_visible_area( int margin ) const
+{
     QAbstractItemModel* model{ m_view.model() };
-    for( int row{ first_switch_row_pos }; row < model->rowCount(); ++row )
+    QSize viewport_size{ m_view.viewport()->size() };
+
+    // Positions past the board's end give invalid indices
+    QModelIndex first_index{ m_view.indexAt( QPoint{ 0, 0 } ) };
+    QModelIndex last_row_index{ m_view.indexAt( QPoint{ 0, viewport_size.height() - 1 } ) };
+    QModelIndex last_col_index{ m_view.indexAt( QPoint{ viewport_size.width() - 1, 0 } ) };
+
+    board_area area;
+    area.top = std::max( 0, first_index.isValid()? first_index.row() - margin : 0 );
+    area.left = std::max( 0, first_index.isValid()? first_index.column() - margin : 0 );
+    area.bottom = std::min( model->rowCount() - 1, last_row_index.isValid()?
+                                last_row_index.row() + margin : model->rowCount() - 1 );
+    area.right = std::min( model->columnCount() - 1, last_col_index.isValid()?
+                               last_col_index.column() + margin : model->columnCount() - 1 );
+
+    return area;
+}
+
+void graphics_delegate::recycle_hidden_cells()
+{
+    const board_model* model{ static_cast< const board_model* >( m_view.model() ) };
+    board_area visible{ get_visible_area( 0 ) };
+    board_area kept{ get_visible_area( hidden_cells_margin ) };
+    int completed{ 0 };
+    uint64_t completed_generation{ 0 };
+
+    for( uint32_t slot_pos{ 0 }; slot_pos < m_slots.size(); ++slot_pos )
     {
-        for( int col{ 0 }; col < model->columnCount(); ++col )
+        cell_slot& slot = m_slots[ slot_pos ];
+        if( slot.shown_state == state_not_shown )
         {
-            auto movie_vh = new QMovie{ get_image_name( data_state::switch_horizontal ), {}, this };
-            auto movie_hv = new QMovie{ get_image_name( data_state::switch_vertical ), {}, this };
+            continue;
+        }
+
+        int row{ static_cast< int >( slot.cell_pos / m_columns ) };
+        int col{ static_cast< int >( slot.cell_pos % m_columns ) };
+        if( row < kept.top || row > kept.bottom || col < kept.left || col > kept.right )
+        {
+            release_slot( slot_pos );
+        }
+        else if( slot.is_pending &&
+                 ( row < visible.top || row > visible.bottom || col < visible.left || col > visible.right ) )
+        {
+            // Scrolled away before its animation started
+            if( completed && slot.generation != completed_generation )
+            {
+                emit animation_completed( completed, completed_generation );
+                completed = 0;
+            }
+
+            completed_generation = slot.generation;
+            update_cell( slot, model->state( row, col ), false );
+            ++completed;
+        }
+    }
+
+    if( completed )
+    {
+        emit animation_completed( completed, completed_generation );
+    }
+}
+
+void graphics_delegate::complete_hidden_changes( const QModelIndex& top_left, const QModelIndex& bottom_right )
+{
+    const board_model* model{ static_cast< const board_model* >( m_view.model() ) };
+    if( !model->is_animated() )
+    {
+        return;
+    }
 
-            QObject::connect( movie_hv, SIGNAL( finished() ), this, SIGNAL( animation_completed() ) );
-            QObject::connect( movie_vh, SIGNAL( finished() ), this, SIGNAL( animation_completed() ) );
+    // Only switches already shown in the viewport get animated, the move does not wait for the rest
+    board_area area{ get_visible_area( 0 ) };
+    int top{ std::max( { top_left.row(), area.top, static_cast< int >( first_switch_row_pos ) } ) };
+    int left{ std::max( top_left.column(), area.left ) };
+    int bottom{ std::min( bottom_right.row(), area.bottom ) };
+    int right{ std::min( bottom_right.column(), area.right ) };
 
-            movie_hv->setScaledSize( m_image_size );
-            movie_vh->setScaledSize( m_image_size );
+    int animated{ 0 };
+    for( int row{ top }; row <= bottom; ++row )
+    {
+        for( int col{ left }; col <= right; ++col )
+        {
+            auto it = m_cell_slots.find( static_cast< size_t >( row ) * static_cast< size_t >( m_columns ) +
+                                         static_cast< size_t >( col ) );
+            if( it == m_cell_slots.end() )
+            {
+                continue;
+            }
 
-            m_switch_movies.insert( model->index( row, col ), { movie_vh, movie_hv } );
+            cell_slot& slot = m_slots[ it->second ];
+            if( !slot.is_pending &&
+                slot.shown_state != state_not_shown &&
+                slot.shown_state != as_int( model->state( row, col ) ) )
+            {
+                slot.is_pending = true;
+                slot.generation = model->generation();
+                ++animated;
+            }
         }
     }
+
+    // Switches in the margin are not painted, they show their new state once scrolled in
+    for( cell_slot& slot : m_slots )
+    {
+        int row{ static_cast< int >( slot.cell_pos / m_columns ) };
+        int col{ static_cast< int >( slot.cell_pos % m_columns ) };
+        if( slot.shown_state == state_not_shown || row < first_switch_row_pos ||
+            ( row >= area.top && row <= area.bottom && col >= area.left && col <= area.right ) )
+        {
+            continue;
+        }
+
+        data_state state{ model->state( row, col ) };
+        if( slot.shown_state != as_int( state ) )
+        {
+            update_cell( slot, state, false );
+        }
+    }
+
+    int hidden{ static_cast< int >( model->changed_switches() ) - animated };
+    if( hidden > 0 )
+    {
+        emit animation_completed( hidden, model->generation() );
+    }
 }
 
+const QVector< QPixmap >& graphics_delegate::get_frames( uint8_t state ) const noexcept
+{
+    return m_atlas.get_frames( as_enum< data_state >( state ) );
+}
+
+size_t graphics_delegate::get_cell_pos( const QModelIndex& index ) const noexcept
+{
+    return static_cast< size_t >( index.row() ) * static_cast< size_t >( m_columns ) +
+            static_cast< size_t >( index.column() );
+}
+
+QModelIndex graphics_delegate::get_cell_index( size_t cell_pos ) const
+{
+    return m_view.model()->index( static_cast< int >( cell_pos / m_columns ),
+                                  static_cast< int >( cell_pos % m_columns ) );
+}
+
+graphics_delegate::cell_slot& graphics_delegate::get_slot( size_t cell_pos ) const
+{
+    auto it = m_cell_slots.find( cell_pos );
+    if( it != m_cell_slots.end() )
+    {
+        return m_slots[ it->second ];
+    }
+
+    uint32_t slot_pos{ static_cast< uint32_t >( m_slots.size() ) };
+    if( m_free_slots.empty() )
+    {
+        m_slots.emplace_back();
+    }
+    else
+    {
+        slot_pos = m_free_slots.back();
+        m_free_slots.pop_back();
+    }
+
+    m_cell_slots.emplace( cell_pos, slot_pos );
+
+    cell_slot& slot = m_slots[ slot_pos ];
+    slot = cell_slot{};
+    slot.cell_pos = cell_pos;
+    slot.shown_state = state_not_shown;
+
+    return slot;
+}
+
+void graphics_delegate::release_slot( uint32_t slot_pos )
+{
+    cell_slot& slot = m_slots[ slot_pos ];
+
+    if( slot.is_running )
+    {
+        m_running_slots.erase( std::find( m_running_slots.begin(), m_running_slots.end(), slot_pos ) );
+    }
+
+    if( slot.is_running || slot.is_pending )
+    {
+        // The move still waits for this animation
+        emit animation_completed( 1, slot.generation );
+    }
+
+    if( m_mode == render_mode::widgets )
+    {
+        m_view.setIndexWidget( get_cell_index( slot.cell_pos ), nullptr );
+    }
+
+    m_cell_slots.erase( slot.cell_pos );
+    m_free_slots.push_back( slot_pos );
+    slot = cell_slot{};
+    slot.shown_state = state_not_shown;
+}
+
+void graphics_delegate::update_cell( cell_slot& slot, const data_state& state, bool animated ) const
+{
+    bool first_shown{ slot.shown_state == state_not_shown };
+    slot.shown_state = as_int( state );
+    slot.is_pending = false;
+
+    // Cells scrolled into view show their current state right away
+    if( !animated || ( first_shown && m_first_frame_painted ) )
+    {
+        // Jumps to the last frame, a running animation finishes on the next tick
+        slot.frame_pos = static_cast< uint16_t >( get_frames( as_int( state ) ).size() - 1 );
+        return;
+    }
+
+    // Restarts the animation if the switch was already moving
+    if( !slot.is_running )
+    {
+        slot.is_running = true;
+        m_running_slots.push_back( static_cast< uint32_t >( &slot - m_slots.data() ) );
+    }
+
+    slot.frame_pos = 0;
+
+    if( !m_clock.isActive() )
+    {
+        m_clock.start();
+    }
+}
@@ -1,21 +1,33 @@
 #ifndef MOVIE_DELEGATE_HPP
 #define MOVIE_DELEGATE_HPP
 
-#include <QMap>
-#include <QMovie>
+#include <vector>
+#include <unordered_map>
+
+#include <QTimer>
+#include <QVector>
+#include <QPixmap>
 #include <QAbstractItemView>
 #include <QStyledItemDelegate>
 
 #include "common.h"
+#include "asset_atlas.h"
+#include "board_snapshot.h"
 
-// Paints animations and images instead of data_state values
+// Paints animations and images instead of data_state values.
+// Switch animations are decoded once, and a single clock moves every running one.
+// Render state is kept only for the cells around the viewport, cells scrolled away give it up.
 
 class graphics_delegate : public QStyledItemDelegate
 {
     Q_OBJECT
 
 public:
-    graphics_delegate( const QSize& image_size, QAbstractItemView& view, QObject* parent = nullptr );
+    graphics_delegate( const QSize& image_size,
+                       const render_mode& mode,
+                       const repaint_mode& repaint,
+                       QAbstractItemView& view,
+                       QObject* parent = nullptr );
 
     void paint( QPainter* painter,
                 const QStyleOptionViewItem& option,
@@ -23,18 +35,74 @@ public:
 
     QSize sizeHint( const QStyleOptionViewItem& option, const QModelIndex& index ) const override;
 
+    // Cells painted since the start
+    uint64_t get_paints_count() const noexcept;
+
+    // Plays switch animations speed times faster than their frame delay says
+    void set_animation_speed( double speed );
+
 signals:
-    void animation_completed();
+    // Count animations showing changes of the given board generation have finished
+    void animation_completed( int count, quint64 generation );
+    void first_frame_painted() const;
+
+private slots:
+    void advance_animations();
+    void recycle_hidden_cells();
+    void complete_hidden_changes( const QModelIndex& top_left, const QModelIndex& bottom_right );
 
 private:
+    // Render state of a cell around the viewport
+    struct cell_slot
+    {
+        size_t cell_pos{ 0 };
+        uint8_t shown_state{ 0 };
+        uint16_t frame_pos{ 0 };
+        bool is_running{ false };
+
+        // Changed while visible, the move waits for its animation
+        bool is_pending{ false };
+
+        // Board generation whose change is being animated
+        uint64_t generation{ 0 };
+    };
+
     void init();
+    const QVector< QPixmap >& get_frames( uint8_t state ) const noexcept;
+    size_t get_cell_pos( const QModelIndex& index ) const noexcept;
+    QModelIndex get_cell_index( size_t cell_pos ) const;
+    board_area get_visible_area( int margin ) const;
+    cell_slot& get_slot( size_t cell_pos ) const;
+    void release_slot( uint32_t slot_pos );
+    void update_cell( cell_slot& slot, const data_state& state, bool animated ) const;
+
+    void paint_widget( const QModelIndex& index, const data_state& state ) const;
+    void paint_direct( QPainter* painter,
+                       const QStyleOptionViewItem& option,
+                       const QModelIndex& index,
+                       const data_state& state ) const;
 
 private:
     QAbstractItemView& m_view;
 
     QSize m_image_size;
-    QMap< data_state, QPixmap > m_lock_pixmaps;
-    QMap< QModelIndex, QPair< QMovie*, QMovie* > > m_switch_movies;
+    render_mode m_mode{ render_mode::widgets };
+    repaint_mode m_repaint{ repaint_mode::on_change };
+    mutable uint64_t m_paints_count{ 0 };
+    mutable bool m_first_frame_painted{ false };
+
+    // Pre-scaled lock images and frames shared by all switches
+    asset_atlas m_atlas;
+
+    // Slots of the cells painted so far, the ones of hidden cells are reused.
+    // Running animations are listed separately
+    mutable QTimer m_clock;
+    int m_frame_delay{ 0 };
+    int m_columns{ 0 };
+    mutable std::vector< cell_slot > m_slots;
+    mutable std::vector< uint32_t > m_free_slots;
+    mutable std::unordered_map< size_t, uint32_t > m_cell_slots;
+    mutable std::vector< uint32_t > m_running_slots;
 };
 
 #endif
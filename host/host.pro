@@ -0,0 +1,23 @@
+#-------------------------------------------------
+#
+# Headless host of many game sessions behind a Unix socket
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = host
+TEMPLATE = app
+
+CONFIG += c++11 console thread
+CONFIG -= app_bundle
+
+include(../engine.pri)
+
+SOURCES += \
+    main.cpp \
+    session_store.cpp
+
+HEADERS += \
+    protocol.h \
+    session_store.h
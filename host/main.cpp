@@ -0,0 +1,837 @@
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cerrno>
+#include <cstring>
+#include <csignal>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+
+#include "protocol.h"
+#include "session_store.h"
+
+// Keeps many independent game sessions in one process and serves them over a Unix socket.
+// Every worker thread owns its connections and the sessions created through them,
+// so requests never wait for a lock or for another worker. Sessions belong to the connection
+// that created them and end with it.
+
+struct host_settings
+{
+    std::string socket_path{ "locks.sock" };
+    size_t grid_size{ 3 };
+    size_t action_buffer_size{ 5 };
+    size_t workers{ std::max( 1u, std::thread::hardware_concurrency() ) };
+    size_t max_sessions{ 100000 };
+};
+
+struct client_settings
+{
+    std::string socket_path{ "locks.sock" };
+    size_t connections{ 1 };
+    size_t sessions{ 100 };
+    size_t moves{ 100000 };
+    size_t pipeline{ 1 };
+};
+
+static std::atomic< bool > stopping{ false };
+
+void on_stop_signal( int )
+{
+    stopping = true;
+}
+
+host_settings get_settings( int argc, char** argv )
+{
+    enum args_pos{ socket_path_pos = 1,
+                   grid_size_pos,
+                   action_buffer_size_pos,
+                   workers_pos,
+                   max_sessions_pos };
+
+    host_settings settings;
+
+    if( argc >= socket_path_pos + 1 )
+    {
+        settings.socket_path = argv[ socket_path_pos ];
+    }
+
+    if( argc >= grid_size_pos + 1 )
+    {
+        int grid_size{ std::stoi( argv[ grid_size_pos ] ) };
+        if( grid_size <= 0 )
+        {
+            throw std::invalid_argument{ "Grid size should be positive" };
+        }
+
+        settings.grid_size = grid_size;
+    }
+
+    if( argc >= action_buffer_size_pos + 1 )
+    {
+        int action_buffer_size{ std::stoi( argv[ action_buffer_size_pos ] ) };
+        if( action_buffer_size <= 0 )
+        {
+            throw std::invalid_argument{ "Buffer size should be positive" };
+        }
+
+        settings.action_buffer_size = action_buffer_size;
+    }
+
+    if( argc >= workers_pos + 1 )
+    {
+        int workers{ std::stoi( argv[ workers_pos ] ) };
+        if( workers <= 0 )
+        {
+            throw std::invalid_argument{ "Workers number should be positive" };
+        }
+
+        settings.workers = workers;
+    }
+
+    if( argc >= max_sessions_pos + 1 )
+    {
+        long long max_sessions{ std::stoll( argv[ max_sessions_pos ] ) };
+        if( max_sessions <= 0 )
+        {
+            throw std::invalid_argument{ "Max sessions number should be positive" };
+        }
+
+        settings.max_sessions = max_sessions;
+    }
+
+    return settings;
+}
+
+client_settings get_client_settings( int argc, char** argv )
+{
+    // Positions follow --client
+    enum args_pos{ socket_path_pos = 2,
+                   connections_pos,
+                   sessions_pos,
+                   moves_pos,
+                   pipeline_pos };
+
+    client_settings settings;
+
+    auto get_positive = [ argc, argv ]( int pos, const char* error )
+    {
+        long long value{ std::stoll( argv[ pos ] ) };
+        if( value <= 0 )
+        {
+            throw std::invalid_argument{ error };
+        }
+
+        return static_cast< size_t >( value );
+    };
+
+    if( argc >= socket_path_pos + 1 )
+    {
+        settings.socket_path = argv[ socket_path_pos ];
+    }
+
+    if( argc >= connections_pos + 1 )
+    {
+        settings.connections = get_positive( connections_pos, "Connections number should be positive" );
+    }
+
+    if( argc >= sessions_pos + 1 )
+    {
+        settings.sessions = get_positive( sessions_pos, "Sessions number should be positive" );
+    }
+
+    if( argc >= moves_pos + 1 )
+    {
+        settings.moves = get_positive( moves_pos, "Moves number should be positive" );
+    }
+
+    if( argc >= pipeline_pos + 1 )
+    {
+        settings.pipeline = get_positive( pipeline_pos, "Pipeline depth should be positive" );
+    }
+
+    return settings;
+}
+
+sockaddr_un get_socket_address( const std::string& socket_path )
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+
+    if( socket_path.size() >= sizeof( address.sun_path ) )
+    {
+        throw std::invalid_argument{ "Socket path is too long" };
+    }
+
+    std::copy( socket_path.begin(), socket_path.end(), address.sun_path );
+    return address;
+}
+
+class worker
+{
+public:
+    worker( size_t index, const host_settings& settings ) :
+        m_index( index ),
+        m_workers( settings.workers ),
+        m_sessions( settings.grid_size, settings.action_buffer_size, settings.max_sessions )
+    {
+        if( pipe( m_wake_pipe ) )
+        {
+            throw std::runtime_error{ "Failed to create a worker pipe" };
+        }
+
+        // A full pipe must not block the accepting thread, the worker is awake by then anyway
+        if( fcntl( m_wake_pipe[ 0 ], F_SETFL, O_NONBLOCK ) < 0 || fcntl( m_wake_pipe[ 1 ], F_SETFL, O_NONBLOCK ) < 0 )
+        {
+            close( m_wake_pipe[ 0 ] );
+            close( m_wake_pipe[ 1 ] );
+            throw std::runtime_error{ "Failed to make a worker pipe non-blocking" };
+        }
+    }
+
+    ~worker()
+    {
+        for( connection& client : m_connections )
+        {
+            close( client.fd );
+        }
+
+        for( int fd : m_new_connections )
+        {
+            close( fd );
+        }
+
+        close( m_wake_pipe[ 0 ] );
+        close( m_wake_pipe[ 1 ] );
+    }
+
+    // Called by the accepting thread
+    void add_connection( int fd )
+    {
+        {
+            std::lock_guard< std::mutex > lock{ m_new_connections_mutex };
+            m_new_connections.push_back( fd );
+        }
+
+        wake();
+    }
+
+    void wake()
+    {
+        char byte{ 0 };
+        if( write( m_wake_pipe[ 1 ], &byte, 1 ) < 0 && errno != EAGAIN )
+        {
+            std::cerr << "Failed to wake worker " << m_index << std::endl;
+        }
+    }
+
+    void run()
+    {
+        std::vector< pollfd > fds;
+
+        while( !stopping )
+        {
+            fds.clear();
+            fds.push_back( { m_wake_pipe[ 0 ], POLLIN, 0 } );
+
+            for( const connection& client : m_connections )
+            {
+                // Clients not reading their responses stop being read too
+                short events{ static_cast< short >( client.out.size() - client.out_pos < max_pending_output? POLLIN : 0 ) };
+                if( client.out_pos < client.out.size() )
+                {
+                    events |= POLLOUT;
+                }
+
+                fds.push_back( { client.fd, events, 0 } );
+            }
+
+            if( poll( fds.data(), fds.size(), -1 ) < 0 )
+            {
+                if( errno == EINTR )
+                {
+                    continue;
+                }
+
+                // Nothing to recover, the whole host goes down
+                std::cerr << "Worker " << m_index << " failed to poll: " << std::strerror( errno ) << std::endl;
+                stopping = true;
+                kill( getpid(), SIGTERM );
+                return;
+            }
+
+            if( fds[ 0 ].revents )
+            {
+                accept_new_connections();
+            }
+
+            // New connections are appended, so positions of the polled ones still match
+            for( size_t pos{ fds.size() - 1 }; pos > 0; --pos )
+            {
+                if( fds[ pos ].revents && !serve( m_connections[ pos - 1 ], fds[ pos ].revents ) )
+                {
+                    close_connection( pos - 1 );
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr size_t read_size{ 64 * 1024 };
+    static constexpr size_t max_pending_output{ 1024 * 1024 };
+
+    struct connection
+    {
+        connection( int client_fd, uint64_t client_id ) : fd( client_fd ), id( client_id ){}
+
+        int fd;
+        uint64_t id;
+
+        // Slots of the sessions created through the connection and not ended yet
+        std::vector< uint32_t > sessions;
+
+        std::vector< char > in;
+        std::vector< char > out;
+        size_t out_pos{ 0 };
+    };
+
+    void accept_new_connections()
+    {
+        char bytes[ 64 ];
+        while( read( m_wake_pipe[ 0 ], bytes, sizeof( bytes ) ) > 0 );
+
+        std::lock_guard< std::mutex > lock{ m_new_connections_mutex };
+        for( int fd : m_new_connections )
+        {
+            if( fcntl( fd, F_SETFL, O_NONBLOCK ) < 0 )
+            {
+                std::cerr << "Failed to make a connection non-blocking" << std::endl;
+                close( fd );
+                continue;
+            }
+
+            m_connections.emplace_back( fd, m_next_connection_id++ );
+        }
+
+        m_new_connections.clear();
+    }
+
+    void close_connection( size_t pos )
+    {
+        connection& client = m_connections[ pos ];
+        for( uint32_t slot : client.sessions )
+        {
+            m_sessions.end( slot );
+            m_session_owners[ slot ] = 0;
+        }
+
+        close( client.fd );
+        m_connections.erase( m_connections.begin() + static_cast< std::ptrdiff_t >( pos ) );
+    }
+
+    // Returns false once the connection should be closed
+    bool serve( connection& client, short events )
+    {
+        if( events & ( POLLERR | POLLNVAL ) )
+        {
+            return false;
+        }
+
+        if( events & ( POLLIN | POLLHUP ) )
+        {
+            ssize_t read_bytes{ read( client.fd, m_read_buffer, read_size ) };
+            if( read_bytes == 0 || ( read_bytes < 0 && errno != EAGAIN && errno != EINTR ) )
+            {
+                return false;
+            }
+
+            const char* data{ m_read_buffer };
+            size_t size{ static_cast< size_t >( std::max< ssize_t >( read_bytes, 0 ) ) };
+
+            // Requests are answered straight from the read buffer unless a partial one is waiting
+            if( !client.in.empty() )
+            {
+                client.in.insert( client.in.end(), data, data + size );
+                data = client.in.data();
+                size = client.in.size();
+            }
+
+            // Every complete request is answered, a partial one waits for the rest
+            size_t requests{ size / sizeof( request ) };
+            for( size_t pos{ 0 }; pos < requests; ++pos )
+            {
+                request next_request;
+                std::memcpy( &next_request, data + pos * sizeof( request ), sizeof( request ) );
+                handle( next_request, client );
+            }
+
+            size_t handled_size{ requests * sizeof( request ) };
+            if( client.in.empty() )
+            {
+                client.in.assign( data + handled_size, data + size );
+            }
+            else
+            {
+                client.in.erase( client.in.begin(), client.in.begin() + static_cast< std::ptrdiff_t >( handled_size ) );
+            }
+        }
+
+        if( client.out_pos < client.out.size() )
+        {
+            ssize_t written{ write( client.fd, client.out.data() + client.out_pos, client.out.size() - client.out_pos ) };
+            if( written < 0 && errno != EAGAIN && errno != EINTR )
+            {
+                return false;
+            }
+
+            client.out_pos += static_cast< size_t >( std::max< ssize_t >( written, 0 ) );
+            if( client.out_pos == client.out.size() )
+            {
+                client.out.clear();
+                client.out_pos = 0;
+            }
+        }
+
+        return true;
+    }
+
+    void handle( const request& next_request, connection& client )
+    {
+        std::vector< char >& out = client.out;
+
+        response result{};
+        result.status = response_status::ok;
+        result.session = next_request.session;
+
+        uint32_t slot{ 0 };
+        bool is_own_session{ next_request.session != no_session &&
+                             ( next_request.session - 1 ) % m_workers == m_index };
+        if( is_own_session )
+        {
+            slot = static_cast< uint32_t >( ( next_request.session - 1 ) / m_workers );
+            is_own_session = slot < m_session_owners.size() && m_session_owners[ slot ] == client.id;
+        }
+
+        bool send_board{ false };
+        size_t grid_size{ m_sessions.grid_size() };
+
+        if( next_request.type == request_type::new_game && next_request.session == no_session )
+        {
+            if( m_sessions.create( slot ) )
+            {
+                result.session = static_cast< uint32_t >( slot * m_workers + m_index + 1 );
+                m_sessions.new_game( slot, next_request.argument );
+
+                if( slot >= m_session_owners.size() )
+                {
+                    m_session_owners.resize( slot + 1, 0 );
+                }
+
+                m_session_owners[ slot ] = client.id;
+                client.sessions.push_back( slot );
+            }
+            else
+            {
+                result.status = response_status::no_free_sessions;
+            }
+        }
+        else if( !is_own_session )
+        {
+            result.status = response_status::unknown_session;
+        }
+        else
+        {
+            switch( next_request.type )
+            {
+            case request_type::new_game:
+                m_sessions.new_game( slot, next_request.argument );
+                break;
+
+            case request_type::click:
+            {
+                uint64_t row{ next_request.argument >> 32 };
+                uint64_t col{ next_request.argument & 0xffffffff };
+
+                if( row < grid_size && col < grid_size )
+                {
+                    m_sessions.click( slot, row, col );
+                }
+                else
+                {
+                    result.status = response_status::out_of_grid;
+                }
+
+                break;
+            }
+
+            case request_type::undo:
+                result.status = m_sessions.undo( slot )? response_status::ok : response_status::no_action;
+                break;
+
+            case request_type::redo:
+                result.status = m_sessions.redo( slot )? response_status::ok : response_status::no_action;
+                break;
+
+            case request_type::query_state:
+                send_board = true;
+                break;
+
+            case request_type::end_game:
+            {
+                m_sessions.end( slot );
+                m_session_owners[ slot ] = 0;
+
+                auto session_pos = std::find( client.sessions.begin(), client.sessions.end(), slot );
+                *session_pos = client.sessions.back();
+                client.sessions.pop_back();
+                break;
+            }
+
+            default:
+                result.status = response_status::unknown_request;
+                break;
+            }
+        }
+
+        if( result.status != response_status::no_free_sessions && result.status != response_status::unknown_session &&
+            m_sessions.is_open( slot ) )
+        {
+            result.total_actions = m_sessions.total_actions( slot );
+            result.locked_columns = m_sessions.locked_columns( slot );
+            result.score = m_sessions.score( slot );
+        }
+
+        if( send_board )
+        {
+            result.board_words = static_cast< uint32_t >( m_sessions.board_words() );
+        }
+
+        const char* result_bytes{ reinterpret_cast< const char* >( &result ) };
+        out.insert( out.end(), result_bytes, result_bytes + sizeof( result ) );
+
+        if( send_board )
+        {
+            const char* board_bytes{ reinterpret_cast< const char* >( m_sessions.board( slot ) ) };
+            out.insert( out.end(), board_bytes, board_bytes + m_sessions.board_words() * sizeof( uint64_t ) );
+        }
+    }
+
+private:
+    size_t m_index{ 0 };
+    size_t m_workers{ 1 };
+    session_store m_sessions;
+    std::vector< connection > m_connections;
+    uint64_t m_next_connection_id{ 1 };
+
+    // Id of the connection owning each slot, 0 for free slots
+    std::vector< uint64_t > m_session_owners;
+
+    // Connections accepted but not yet taken by the worker
+    std::mutex m_new_connections_mutex;
+    std::vector< int > m_new_connections;
+    int m_wake_pipe[ 2 ]{ -1, -1 };
+
+    // Shared by the connections of the worker, they are read one at a time
+    char m_read_buffer[ read_size ];
+};
+
+constexpr size_t worker::read_size;
+constexpr size_t worker::max_pending_output;
+
+int run_host( const host_settings& settings )
+{
+    sockaddr_un address{ get_socket_address( settings.socket_path ) };
+
+    // A socket left by a previous run is replaced, any other file is not
+    struct stat file_info;
+    if( !stat( settings.socket_path.c_str(), &file_info ) && S_ISSOCK( file_info.st_mode ) )
+    {
+        unlink( settings.socket_path.c_str() );
+    }
+
+    int listen_fd{ socket( AF_UNIX, SOCK_STREAM, 0 ) };
+    if( listen_fd < 0 ||
+        bind( listen_fd, reinterpret_cast< sockaddr* >( &address ), sizeof( address ) ) ||
+        listen( listen_fd, SOMAXCONN ) )
+    {
+        throw std::runtime_error{ std::string{ "Failed to listen on the socket: " } + std::strerror( errno ) };
+    }
+
+    // Only the accepting thread handles stop signals, so they interrupt accept()
+    sigset_t stop_signals;
+    sigemptyset( &stop_signals );
+    sigaddset( &stop_signals, SIGINT );
+    sigaddset( &stop_signals, SIGTERM );
+    pthread_sigmask( SIG_BLOCK, &stop_signals, nullptr );
+
+    std::vector< std::unique_ptr< worker > > workers;
+    std::vector< std::thread > threads;
+    for( size_t index{ 0 }; index < settings.workers; ++index )
+    {
+        workers.emplace_back( new worker{ index, settings } );
+        threads.emplace_back( &worker::run, workers.back().get() );
+    }
+
+    struct sigaction action{};
+    action.sa_handler = on_stop_signal;
+    sigaction( SIGINT, &action, nullptr );
+    sigaction( SIGTERM, &action, nullptr );
+    pthread_sigmask( SIG_UNBLOCK, &stop_signals, nullptr );
+
+    std::cerr << "Serving " << settings.grid_size << "x" << settings.grid_size << " boards on "
+              << settings.socket_path << " with " << settings.workers << " workers" << std::endl;
+
+    // Connections are spread over the workers in turn
+    for( size_t next_worker{ 0 }; !stopping; )
+    {
+        int fd{ accept( listen_fd, nullptr, nullptr ) };
+        if( fd < 0 )
+        {
+            if( errno == EINTR || errno == ECONNABORTED )
+            {
+                continue;
+            }
+
+            std::cerr << "Failed to accept a connection: " << std::strerror( errno ) << std::endl;
+            break;
+        }
+
+        workers[ next_worker ]->add_connection( fd );
+        next_worker = ( next_worker + 1 ) % workers.size();
+    }
+
+    stopping = true;
+    for( size_t index{ 0 }; index < workers.size(); ++index )
+    {
+        workers[ index ]->wake();
+        threads[ index ].join();
+    }
+
+    close( listen_fd );
+    unlink( settings.socket_path.c_str() );
+
+    return 0;
+}
+
+void write_all( int fd, const void* data, size_t size )
+{
+    const char* bytes{ static_cast< const char* >( data ) };
+    while( size )
+    {
+        ssize_t written{ write( fd, bytes, size ) };
+        if( written <= 0 )
+        {
+            throw std::runtime_error{ "Connection to the host is lost" };
+        }
+
+        bytes += written;
+        size -= static_cast< size_t >( written );
+    }
+}
+
+void read_all( int fd, void* data, size_t size )
+{
+    char* bytes{ static_cast< char* >( data ) };
+    while( size )
+    {
+        ssize_t read_bytes{ read( fd, bytes, size ) };
+        if( read_bytes <= 0 )
+        {
+            throw std::runtime_error{ "Connection to the host is lost" };
+        }
+
+        bytes += read_bytes;
+        size -= static_cast< size_t >( read_bytes );
+    }
+}
+
+response read_response( int fd, std::vector< uint64_t >& board )
+{
+    response result;
+    read_all( fd, &result, sizeof( result ) );
+
+    board.resize( result.board_words );
+    read_all( fd, board.data(), board.size() * sizeof( uint64_t ) );
+
+    return result;
+}
+
+// Plays random clicks on its sessions, keeping up to pipeline requests in flight
+void play_client( const client_settings& settings,
+                  size_t client,
+                  std::vector< uint64_t >& latencies_ns )
+{
+    using clock = std::chrono::steady_clock;
+
+    sockaddr_un address{ get_socket_address( settings.socket_path ) };
+    int fd{ socket( AF_UNIX, SOCK_STREAM, 0 ) };
+    if( fd < 0 || connect( fd, reinterpret_cast< sockaddr* >( &address ), sizeof( address ) ) )
+    {
+        throw std::runtime_error{ std::string{ "Failed to connect to the host: " } + std::strerror( errno ) };
+    }
+
+    std::vector< uint64_t > board;
+    std::vector< uint32_t > sessions;
+    for( size_t session{ 0 }; session < settings.sessions; ++session )
+    {
+        request new_game{ request_type::new_game, no_session, client * settings.sessions + session };
+        write_all( fd, &new_game, sizeof( new_game ) );
+
+        response result{ read_response( fd, board ) };
+        if( result.status != response_status::ok )
+        {
+            throw std::runtime_error{ "Host refused a new session" };
+        }
+
+        sessions.push_back( result.session );
+    }
+
+    // Grid size from the board of the first session
+    request query{ request_type::query_state, sessions.front(), 0 };
+    write_all( fd, &query, sizeof( query ) );
+    read_response( fd, board );
+
+    size_t grid_size{ 1 };
+    while( grid_size * ( ( grid_size + game_engine::bits_per_word - 1 ) / game_engine::bits_per_word ) < board.size() )
+    {
+        ++grid_size;
+    }
+
+    // Responses come in the order of the requests
+    xoshiro256 rng{ client };
+    std::vector< clock::time_point > sent( settings.pipeline );
+    size_t sent_num{ 0 };
+    size_t received_num{ 0 };
+    latencies_ns.reserve( settings.moves );
+
+    while( received_num < settings.moves )
+    {
+        while( sent_num < settings.moves && sent_num - received_num < settings.pipeline )
+        {
+            request click{ request_type::click,
+                           sessions[ sent_num % sessions.size() ],
+                           make_click_argument( static_cast< uint32_t >( rng() % grid_size ),
+                                                static_cast< uint32_t >( rng() % grid_size ) ) };
+
+            sent[ sent_num % settings.pipeline ] = clock::now();
+            write_all( fd, &click, sizeof( click ) );
+            ++sent_num;
+        }
+
+        response result{ read_response( fd, board ) };
+        if( result.status != response_status::ok )
+        {
+            throw std::runtime_error{ "Host failed a click" };
+        }
+
+        latencies_ns.push_back( static_cast< uint64_t >(
+                std::chrono::duration_cast< std::chrono::nanoseconds >(
+                        clock::now() - sent[ received_num % settings.pipeline ] ).count() ) );
+        ++received_num;
+    }
+
+    for( uint32_t session : sessions )
+    {
+        request end_game{ request_type::end_game, session, 0 };
+        write_all( fd, &end_game, sizeof( end_game ) );
+        read_response( fd, board );
+    }
+
+    close( fd );
+}
+
+int run_client( const client_settings& settings )
+{
+    std::vector< std::vector< uint64_t > > latencies( settings.connections );
+    std::vector< std::string > errors( settings.connections );
+    std::vector< std::thread > threads;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for( size_t client{ 0 }; client < settings.connections; ++client )
+    {
+        threads.emplace_back( [ &settings, &latencies, &errors, client ]()
+        {
+            try
+            {
+                play_client( settings, client, latencies[ client ] );
+            }
+            catch( const std::exception& e )
+            {
+                errors[ client ] = e.what();
+            }
+        } );
+    }
+
+    for( std::thread& thread : threads )
+    {
+        thread.join();
+    }
+
+    double seconds{ std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count() };
+
+    for( const std::string& error : errors )
+    {
+        if( !error.empty() )
+        {
+            throw std::runtime_error{ error };
+        }
+    }
+
+    std::vector< uint64_t > all_latencies;
+    for( const std::vector< uint64_t >& client_latencies : latencies )
+    {
+        all_latencies.insert( all_latencies.end(), client_latencies.begin(), client_latencies.end() );
+    }
+
+    std::sort( all_latencies.begin(), all_latencies.end() );
+
+    auto percentile_us = [ &all_latencies ]( double quantile )
+    {
+        size_t pos{ static_cast< size_t >( quantile * ( all_latencies.size() - 1 ) ) };
+        return all_latencies[ pos ] / 1000.0;
+    };
+
+    std::cout << "Moves: " << all_latencies.size() << ", time: " << seconds << " s, "
+              << all_latencies.size() / seconds << " moves/sec" << std::endl;
+    std::cout << "Latency: p50 " << percentile_us( 0.5 ) << " us, p99 " << percentile_us( 0.99 )
+              << " us, max " << percentile_us( 1.0 ) << " us" << std::endl;
+
+    return 0;
+}
+
+int main( int argc, char* argv[] )
+{
+    int return_code{ 0 };
+
+    try
+    {
+        // Closed client connections are noticed by failing writes
+        std::signal( SIGPIPE, SIG_IGN );
+
+        if( argc >= 2 && std::string{ argv[ 1 ] } == "--client" )
+        {
+            return run_client( get_client_settings( argc, argv ) );
+        }
+
+        return_code = run_host( get_settings( argc, argv ) );
+    }
+    catch( const std::exception& e )
+    {
+        std::cerr << e.what() << std::endl;
+        return_code = -1;
+    }
+
+    return return_code;
+}
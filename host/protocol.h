@@ -0,0 +1,64 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <cstdint>
+
+// Messages between the host and its clients. The socket is local, so both sides share
+// the byte order and messages are sent as they are laid out in memory.
+// Every request gets exactly one response, in the order of the requests on the connection,
+// so clients may send many requests before reading the responses.
+// Sessions are only reachable through the connection that created them,
+// closing the connection ends all of them.
+
+enum class request_type : uint32_t{ new_game, click, undo, redo, query_state, end_game };
+
+enum class response_status : uint32_t
+{
+    ok,
+    unknown_request,
+    unknown_session,  // never created, ended, or created through another connection
+    out_of_grid,
+    no_action,        // nothing to undo or redo
+    no_free_sessions
+};
+
+// Sessions are numbered from 1
+static constexpr uint32_t no_session{ 0 };
+
+struct request
+{
+    request_type type;
+
+    // new_game with no_session creates a session, otherwise restarts the given one
+    uint32_t session;
+
+    // Seed of new_game, row << 32 | col of click
+    uint64_t argument;
+};
+
+struct response
+{
+    response_status status;
+    uint32_t session;
+    uint32_t total_actions;
+
+    // Columns still locked, 0 once the game is won
+    uint32_t locked_columns;
+
+    // Score of a won game, 0 otherwise
+    uint32_t score;
+
+    // Board words following the response, only query_state sends the board:
+    // a row of 64-bit words per switch row, a set bit is a vertical switch
+    uint32_t board_words;
+};
+
+static_assert( sizeof( request ) == 16, "Requests should have no padding" );
+static_assert( sizeof( response ) == 24, "Responses should have no padding" );
+
+constexpr uint64_t make_click_argument( uint32_t row, uint32_t col ) noexcept
+{
+    return uint64_t{ row } << 32 | col;
+}
+
+#endif
@@ -0,0 +1,197 @@
+#include "session_store.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+// Slots allocated at once when every existing one is taken
+static constexpr size_t sessions_per_chunk{ 1024 };
+
+inline uint32_t popcount( uint64_t word ) noexcept
+{
+    return static_cast< uint32_t >( __builtin_popcountll( word ) );
+}
+
+session_store::session_store( size_t grid_size, size_t action_buffer_size, size_t max_sessions ) :
+    m_grid_size( grid_size ),
+    m_action_buffer_size( action_buffer_size ),
+    m_max_sessions( max_sessions ),
+    m_engine( grid_size )
+{
+    if( !action_buffer_size )
+    {
+        throw std::invalid_argument{ "Buffer size should be positive" };
+    }
+
+    m_board_words = m_grid_size * m_engine.words_per_row();
+}
+
+bool session_store::create( uint32_t& slot )
+{
+    if( !m_free_slots.empty() )
+    {
+        slot = m_free_slots.back();
+        m_free_slots.pop_back();
+    }
+    else
+    {
+        if( m_sessions.size() >= m_max_sessions )
+        {
+            return false;
+        }
+
+        if( m_sessions.size() % sessions_per_chunk == 0 )
+        {
+            m_board_chunks.emplace_back( new uint64_t[ sessions_per_chunk * m_board_words ] );
+            m_history_chunks.emplace_back( new uint32_t[ sessions_per_chunk * m_action_buffer_size ] );
+        }
+
+        slot = static_cast< uint32_t >( m_sessions.size() );
+        m_sessions.emplace_back();
+    }
+
+    m_sessions[ slot ] = session{};
+    m_sessions[ slot ].open = true;
+
+    return true;
+}
+
+bool session_store::is_open( uint32_t slot ) const noexcept
+{
+    return slot < m_sessions.size() && m_sessions[ slot ].open;
+}
+
+void session_store::end( uint32_t slot ) noexcept
+{
+    m_sessions[ slot ].open = false;
+    m_free_slots.push_back( slot );
+}
+
+void session_store::new_game( uint32_t slot, uint64_t seed )
+{
+    xoshiro256 rng{ seed };
+    fill_random( m_engine, rng );
+    std::copy( m_engine.row_data( 0 ), m_engine.row_data( 0 ) + m_board_words, board_data( slot ) );
+
+    session& game = m_sessions[ slot ];
+    game.total_actions = 0;
+    game.history_head = game.history_pos = game.history_size = 0;
+
+    count_locked_columns( slot );
+}
+
+void session_store::click( uint32_t slot, size_t row, size_t col )
+{
+    session& game = m_sessions[ slot ];
+    uint32_t cell{ static_cast< uint32_t >( row * m_grid_size + col ) };
+
+    history( slot )[ ( game.history_head + game.history_pos ) % m_action_buffer_size ] = cell;
+    if( game.history_pos < m_action_buffer_size )
+    {
+        ++game.history_pos;
+    }
+    else
+    {
+        // Overwrote the oldest action
+        game.history_head = static_cast< uint32_t >( ( game.history_head + 1 ) % m_action_buffer_size );
+    }
+
+    game.history_size = game.history_pos;
+    ++game.total_actions;
+    play( slot, cell );
+}
+
+bool session_store::undo( uint32_t slot )
+{
+    session& game = m_sessions[ slot ];
+    if( !game.history_pos )
+    {
+        return false;
+    }
+
+    --game.total_actions;
+    play( slot, history_at( slot, --game.history_pos ) );
+
+    return true;
+}
+
+bool session_store::redo( uint32_t slot )
+{
+    session& game = m_sessions[ slot ];
+    if( game.history_pos >= game.history_size )
+    {
+        return false;
+    }
+
+    ++game.total_actions;
+    play( slot, history_at( slot, game.history_pos++ ) );
+
+    return true;
+}
+
+uint32_t session_store::total_actions( uint32_t slot ) const noexcept
+{
+    return m_sessions[ slot ].total_actions;
+}
+
+uint32_t session_store::locked_columns( uint32_t slot ) const noexcept
+{
+    return m_sessions[ slot ].locked_columns;
+}
+
+uint32_t session_store::score( uint32_t slot ) const noexcept
+{
+    const session& game = m_sessions[ slot ];
+    return game.locked_columns? 0 : calc_score( m_grid_size, game.total_actions );
+}
+
+size_t session_store::grid_size() const noexcept
+{
+    return m_grid_size;
+}
+
+size_t session_store::board_words() const noexcept
+{
+    return m_board_words;
+}
+
+const uint64_t* session_store::board( uint32_t slot ) const noexcept
+{
+    return m_board_chunks[ slot / sessions_per_chunk ].get() + ( slot % sessions_per_chunk ) * m_board_words;
+}
+
+uint64_t* session_store::board_data( uint32_t slot ) noexcept
+{
+    return m_board_chunks[ slot / sessions_per_chunk ].get() + ( slot % sessions_per_chunk ) * m_board_words;
+}
+
+uint32_t* session_store::history( uint32_t slot ) noexcept
+{
+    return m_history_chunks[ slot / sessions_per_chunk ].get() + ( slot % sessions_per_chunk ) * m_action_buffer_size;
+}
+
+uint32_t session_store::history_at( uint32_t slot, uint32_t offset ) noexcept
+{
+    return history( slot )[ ( m_sessions[ slot ].history_head + offset ) % m_action_buffer_size ];
+}
+
+void session_store::play( uint32_t slot, uint32_t cell )
+{
+    uint64_t* words{ board_data( slot ) };
+    std::copy( words, words + m_board_words, m_engine.row_data( 0 ) );
+    m_engine.click( cell / m_grid_size, cell % m_grid_size );
+    std::copy( m_engine.row_data( 0 ), m_engine.row_data( 0 ) + m_board_words, words );
+
+    count_locked_columns( slot );
+}
+
+void session_store::count_locked_columns( uint32_t slot )
+{
+    m_engine.locked_columns( m_locked );
+
+    uint32_t& locked_columns = m_sessions[ slot ].locked_columns;
+    locked_columns = 0;
+    for( uint64_t word : m_locked )
+    {
+        locked_columns += popcount( word );
+    }
+}
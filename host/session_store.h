@@ -0,0 +1,79 @@
+#ifndef SESSION_STORE_H
+#define SESSION_STORE_H
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "game_engine.h"
+
+// Game sessions of a single worker: boards, undo/redo histories and action counters.
+// Boards and histories live in fixed-size chunks of slots allocated on demand and reused
+// once their sessions end, so thousands of sessions take a few allocations in total.
+// Slots are zero-based, the host maps them to session numbers.
+
+class session_store
+{
+public:
+    session_store( size_t grid_size, size_t action_buffer_size, size_t max_sessions );
+
+    // Returns false if all max_sessions slots are taken
+    bool create( uint32_t& slot );
+    bool is_open( uint32_t slot ) const noexcept;
+    void end( uint32_t slot ) noexcept;
+
+    void new_game( uint32_t slot, uint64_t seed );
+    void click( uint32_t slot, size_t row, size_t col );
+
+    // Return false if there is nothing to undo or redo
+    bool undo( uint32_t slot );
+    bool redo( uint32_t slot );
+
+    uint32_t total_actions( uint32_t slot ) const noexcept;
+    uint32_t locked_columns( uint32_t slot ) const noexcept;
+    uint32_t score( uint32_t slot ) const noexcept;
+
+    size_t grid_size() const noexcept;
+    size_t board_words() const noexcept;
+    const uint64_t* board( uint32_t slot ) const noexcept;
+
+private:
+    // Same traversal as traversible_circular_buffer, over a slot of the history arena
+    struct session
+    {
+        bool open{ false };
+        uint32_t total_actions{ 0 };
+        uint32_t locked_columns{ 0 };
+        uint32_t history_head{ 0 };
+        uint32_t history_pos{ 0 };
+        uint32_t history_size{ 0 };
+    };
+
+    uint64_t* board_data( uint32_t slot ) noexcept;
+    uint32_t* history( uint32_t slot ) noexcept;
+    uint32_t history_at( uint32_t slot, uint32_t offset ) noexcept;
+
+    // Plays a click of the cell on the engine and stores the board back
+    void play( uint32_t slot, uint32_t cell );
+
+    // Of the board currently on the engine
+    void count_locked_columns( uint32_t slot );
+
+private:
+    size_t m_grid_size{ 0 };
+    size_t m_board_words{ 0 };
+    size_t m_action_buffer_size{ 0 };
+    size_t m_max_sessions{ 0 };
+
+    std::vector< std::unique_ptr< uint64_t[] > > m_board_chunks;
+    std::vector< std::unique_ptr< uint32_t[] > > m_history_chunks;
+    std::vector< session > m_sessions;
+    std::vector< uint32_t > m_free_slots;
+
+    // Boards are copied in and out, the engine keeps the size-specialized kernels
+    game_engine m_engine;
+    std::vector< uint64_t > m_locked;
+};
+
+#endif
@@ -1,12 +1,25 @@
+#include <vector>
+#include <string>
+#include <random>
+#include <fstream>
 #include <iostream>
 
 #include <QThread>
+#include <QElapsedTimer>
 #include <QApplication>
 #include <QMainWindow>
 
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
 #include "mainwindow.h"
+#include "board_model.h"
 #include "model_controller.h"
+#include "replay.h"
+#include "tracing.h"
 #include "scores_manager.h"
+#include "graphics_delegate.h"
 
 struct game_settings
 {
@@ -15,8 +28,68 @@ struct game_settings
     size_t action_buffer_size{ 5 };
     size_t max_score_records{ 10 };
     QString scores_file_name{ "scores" };
+    render_mode mode{ render_mode::widgets };
+    repaint_mode repaint{ repaint_mode::on_change };
+    bool render_stats{ false };
+    bool startup_stats{ false };
+    QString bank_file_name;
+    difficulty level{ difficulty::normal };
+    toggle_rule rule{ toggle_rule::cross };
+    uint64_t seed{ 0 };
+    QString replays_dir;
+    std::string replay_file_name;
+    bool fast_forward{ false };
+    bool instant_moves{ false };
+    double animation_speed{ 1.0 };
+    std::string trace_file_name;
 };
 
+render_mode get_render_mode( const std::string& name )
+{
+    if( name == "widgets" )
+    {
+        return render_mode::widgets;
+    }
+    else if( name == "direct" )
+    {
+        return render_mode::direct;
+    }
+
+    throw std::invalid_argument{ "Render mode should be one of: widgets, direct" };
+}
+
+repaint_mode get_repaint_mode( const std::string& name )
+{
+    if( name == "on-change" )
+    {
+        return repaint_mode::on_change;
+    }
+    else if( name == "continuous" )
+    {
+        return repaint_mode::continuous;
+    }
+
+    throw std::invalid_argument{ "Repaint mode should be one of: on-change, continuous" };
+}
+
+// Peak resident memory of the process in kilobytes, 0 if unknown
+long peak_memory_kb()
+{
+#ifdef Q_OS_UNIX
+    rusage usage{};
+    if( !getrusage( RUSAGE_SELF, &usage ) )
+    {
+#ifdef Q_OS_MACOS
+        return usage.ru_maxrss / 1024;
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+#endif
+
+    return 0;
+}
+
 game_settings get_settings( int argc, char** argv )
 {
     enum args_pos{ grid_size_pos = 1,
@@ -27,6 +100,93 @@ game_settings get_settings( int argc, char** argv )
 
     game_settings settings;
 
+    std::random_device random_device;
+    settings.seed = uint64_t{ random_device() } << 32 | random_device();
+
+    // Named options may go anywhere, the rest of the params are positional
+    std::vector< char* > positional_args{ argv[ 0 ] };
+    for( int pos{ 1 }; pos < argc; ++pos )
+    {
+        std::string arg{ argv[ pos ] };
+        auto option_value = [ & ]() -> std::string
+        {
+            if( pos + 1 >= argc )
+            {
+                throw std::invalid_argument{ arg + " expects a value" };
+            }
+
+            return argv[ ++pos ];
+        };
+
+        if( arg == "--render" )
+        {
+            settings.mode = get_render_mode( option_value() );
+        }
+        else if( arg == "--repaint" )
+        {
+            settings.repaint = get_repaint_mode( option_value() );
+        }
+        else if( arg == "--render-stats" )
+        {
+            settings.render_stats = true;
+        }
+        else if( arg == "--startup-stats" )
+        {
+            settings.startup_stats = true;
+        }
+        else if( arg == "--bank" )
+        {
+            settings.bank_file_name = QString::fromStdString( option_value() );
+        }
+        else if( arg == "--difficulty" )
+        {
+            settings.level = get_difficulty( option_value() );
+        }
+        else if( arg == "--rule" )
+        {
+            settings.rule = get_toggle_rule( option_value() );
+        }
+        else if( arg == "--seed" )
+        {
+            settings.seed = std::stoull( option_value() );
+        }
+        else if( arg == "--record-replays" )
+        {
+            settings.replays_dir = QString::fromStdString( option_value() );
+        }
+        else if( arg == "--replay" )
+        {
+            settings.replay_file_name = option_value();
+        }
+        else if( arg == "--fast-forward" )
+        {
+            settings.fast_forward = true;
+        }
+        else if( arg == "--instant" )
+        {
+            settings.instant_moves = true;
+        }
+        else if( arg == "--animation-speed" )
+        {
+            settings.animation_speed = std::stod( option_value() );
+            if( settings.animation_speed <= 0 )
+            {
+                throw std::invalid_argument{ "Animation speed should be positive" };
+            }
+        }
+        else if( arg == "--trace" )
+        {
+            settings.trace_file_name = option_value();
+        }
+        else
+        {
+            positional_args.push_back( argv[ pos ] );
+        }
+    }
+
+    argc = static_cast< int >( positional_args.size() );
+    argv = positional_args.data();
+
     if( argc >= grid_size_pos + 1 )
     {
         int grid_size{ std::stoi( argv[ grid_size_pos ] ) };
@@ -87,6 +247,10 @@ game_settings get_settings( int argc, char** argv )
 int main(int argc, char *argv[])
 {
     int return_code{ 0 };
+
+    QElapsedTimer startup_timer;
+    startup_timer.start();
+
     QApplication a{ argc, argv };
 
     QThread thread;
@@ -95,12 +259,71 @@ int main(int argc, char *argv[])
     {
         game_settings settings{ get_settings( argc, argv ) };
 
-        QStandardItemModel model;
-        model_controller controller{ model, settings.grid_size, settings.action_buffer_size };
+        if( !settings.trace_file_name.empty() )
+        {
+            static constexpr size_t trace_events_per_thread{ 1 << 16 };
+            tracer::enable( trace_events_per_thread );
+        }
+
+        // Replays bring their own grid and buffer sizes and rule
+        replay playback;
+        if( !settings.replay_file_name.empty() )
+        {
+            std::ifstream in{ settings.replay_file_name, std::ios::binary };
+            if( !in )
+            {
+                throw std::ios_base::failure{ "Failed to open replay" };
+            }
+
+            playback = read_replay( in );
+            settings.grid_size = playback.grid_size;
+            settings.action_buffer_size = playback.buffer_size;
+            settings.rule = playback.rule;
+        }
+
+        board_model model;
+        model_controller controller{ model,
+                                     settings.grid_size,
+                                     settings.action_buffer_size,
+                                     settings.bank_file_name,
+                                     settings.level,
+                                     settings.seed,
+                                     settings.rule };
+        controller.set_replays_dir( settings.replays_dir );
+        controller.set_instant_moves( settings.instant_moves );
         controller.moveToThread( &thread );
 
-        scores_manager manager{ settings.scores_file_name, settings.max_score_records };
-        main_window w{ settings.image_size, controller, manager };
+        scores_manager manager{ settings.scores_file_name, settings.max_score_records, settings.grid_size };
+        main_window w{ settings.image_size, settings.mode, settings.repaint, controller, manager };
+
+        if( settings.render_stats )
+        {
+            w.enable_render_stats();
+        }
+
+        w.set_instant_moves( settings.instant_moves );
+        w.get_delegate()->set_animation_speed( settings.animation_speed );
+
+        if( tracer::is_enabled() )
+        {
+            w.enable_trace_dump( QString::fromStdString( settings.trace_file_name ) );
+        }
+
+        if( settings.startup_stats )
+        {
+            QObject::connect( w.get_delegate(),
+                              &graphics_delegate::first_frame_painted,
+                              [ &startup_timer, &settings ]()
+            {
+                std::cout << "Grid " << settings.grid_size << "x" << settings.grid_size
+                          << ( settings.mode == render_mode::direct? ", direct" : ", widgets" )
+                          << ", first frame after " << startup_timer.elapsed() << " ms"
+                          << ", peak memory " << peak_memory_kb() << " KB" << std::endl;
+
+                // One start is one measurement, so runs can be scripted
+                QApplication::quit();
+            } );
+        }
 
         QObject::connect( w.get_view(),
                           SIGNAL( clicked( const QModelIndex& ) ),
@@ -108,9 +331,9 @@ int main(int argc, char *argv[])
                           SLOT( on_click( const QModelIndex& ) ) );
 
         QObject::connect( &controller,
-                          SIGNAL( index_changed( const QModelIndex& ) ),
-                          w.get_view(),
-                          SLOT( update( const QModelIndex& ) ) );
+                          SIGNAL( board_published() ),
+                          &model,
+                          SLOT( refresh() ) );
 
         QObject::connect( &controller,
                           SIGNAL( victory( int ) ),
@@ -132,12 +355,66 @@ int main(int argc, char *argv[])
                           &controller,
                           SLOT( redo() ) );
 
+        QObject::connect( &w,
+                          SIGNAL( hint() ),
+                          &controller,
+                          SLOT( hint() ) );
+
+        QObject::connect( &w,
+                          SIGNAL( auto_solve() ),
+                          &controller,
+                          SLOT( auto_solve() ) );
+
+        QObject::connect( &w,
+                          SIGNAL( instant_moves( bool ) ),
+                          &controller,
+                          SLOT( set_instant_moves( bool ) ) );
+
+        QObject::connect( &controller,
+                          SIGNAL( hint_ready( int, int, int ) ),
+                          &w,
+                          SLOT( show_hint( int, int, int ) ) );
+
+        QObject::connect( &controller,
+                          SIGNAL( unsolvable() ),
+                          &w,
+                          SLOT( show_unsolvable() ) );
+
+        QObject::connect( &controller,
+                          SIGNAL( input_stats( int, int ) ),
+                          &w,
+                          SLOT( show_input_stats( int, int ) ) );
+
+        QObject::connect( &controller,
+                          SIGNAL( game_started( quint64 ) ),
+                          &w,
+                          SLOT( show_seed( quint64 ) ) );
+
+        QObject::connect( &controller,
+                          SIGNAL( replay_finished( int, int ) ),
+                          &w,
+                          SLOT( show_replay_result( int, int ) ) );
+
+        if( !settings.replay_file_name.empty() )
+        {
+            controller.start_replay( playback, settings.fast_forward );
+        }
+
+        // The first board got published before anyone was listening
+        model.refresh();
+        w.show_seed( controller.get_seed() );
+
         thread.start();
         w.show();
         return_code = a.exec();
 
         thread.quit();
         thread.wait();
+
+        if( tracer::is_enabled() )
+        {
+            tracer::dump( settings.trace_file_name );
+        }
     }
     catch( const std::exception& e )
     {
@@ -1,17 +1,53 @@
 #include "mainwindow.h"
 
+#include <algorithm>
+
 #include <QMenuBar>
+#include <QStatusBar>
 #include <QScrollBar>
 #include <QHeaderView>
 #include <QMessageBox>
+#include <QWheelEvent>
+#include <QGuiApplication>
+#include <QScreen>
 
 #include "model_controller.h"
 #include "scores_manager.h"
 #include "graphics_delegate.h"
+#include "tracing.h"
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
 
 enum col_type{ score_pos_col, score_value_col };
 
+static constexpr int render_stats_interval_ms{ 1000 };
+
+static constexpr double zoom_step{ 1.25 };
+static constexpr double max_zoom{ 4.0 };
+static constexpr int min_cell_size{ 2 };
+
+// Part of the screen a board may take before it gets scrollbars
+static constexpr double max_screen_share{ 0.8 };
+
+// User and system time spent by all threads of the process, -1 if unknown
+int64_t process_cpu_time_us()
+{
+#ifdef Q_OS_UNIX
+    rusage usage{};
+    if( !getrusage( RUSAGE_SELF, &usage ) )
+    {
+        return ( usage.ru_utime.tv_sec + usage.ru_stime.tv_sec ) * int64_t{ 1000000 } +
+                usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+    }
+#endif
+    return -1;
+}
+
 main_window::main_window(const QSize& images_size,
+                          const render_mode& mode,
+                          const repaint_mode& repaint,
                           model_controller& controller,
                           scores_manager& manager,
                           QWidget* parent ):
@@ -20,9 +56,16 @@ main_window::main_window(const QSize& images_size,
 {
     create_menus();
     create_scores_widget();
-    create_view( controller, images_size );
+    create_view( controller, images_size, mode, repaint );
 
     setCentralWidget( m_game_view );
+
+    m_input_stats_label = new QLabel{ this };
+    statusBar()->addPermanentWidget( m_input_stats_label );
+
+    m_seed_label = new QLabel{ this };
+    m_seed_label->setTextInteractionFlags( Qt::TextSelectableByMouse );
+    statusBar()->addPermanentWidget( m_seed_label );
 }
 
 QTableView* main_window::get_view() const noexcept
@@ -30,13 +73,83 @@ QTableView* main_window::get_view() const noexcept
     return m_game_view;
 }
 
+graphics_delegate* main_window::get_delegate() const noexcept
+{
+    return m_delegate;
+}
+
+void main_window::enable_trace_dump( const QString& file_name )
+{
+    if( m_dump_trace_action )
+    {
+        return;
+    }
+
+    m_dump_trace_action = new QAction( "Dump trace", this );
+    connect( m_dump_trace_action, &QAction::triggered, [ this, file_name ]()
+    {
+        try
+        {
+            tracer::dump( file_name.toStdString() );
+            statusBar()->showMessage( QString{ "Trace written to %1" }.arg( file_name ) );
+        }
+        catch( const std::exception& e )
+        {
+            statusBar()->showMessage( e.what() );
+        }
+    } );
+
+    m_menu->addAction( m_dump_trace_action );
+}
+
+void main_window::enable_render_stats()
+{
+    if( m_render_stats_label )
+    {
+        return;
+    }
+
+    m_render_stats_label = new QLabel{ this };
+    statusBar()->addPermanentWidget( m_render_stats_label );
+
+    m_last_paints_count = m_delegate->get_paints_count();
+    m_last_cpu_time_us = process_cpu_time_us();
+    m_render_stats_clock.start();
+
+    connect( &m_render_stats_timer, &QTimer::timeout, [ this ]()
+    {
+        uint64_t paints_count{ m_delegate->get_paints_count() };
+        int64_t cpu_time_us{ process_cpu_time_us() };
+        double elapsed_ms{ static_cast< double >( m_render_stats_clock.restart() ) };
+
+        QString text{ QString{ "Paints/s: %1" }.arg( ( paints_count - m_last_paints_count ) * 1000.0 / elapsed_ms, 0, 'f', 0 ) };
+        if( cpu_time_us >= 0 && m_last_cpu_time_us >= 0 )
+        {
+            text += QString{ ", CPU: %1%" }.arg( ( cpu_time_us - m_last_cpu_time_us ) / ( elapsed_ms * 10.0 ), 0, 'f', 1 );
+        }
+
+        m_render_stats_label->setText( text );
+        m_last_paints_count = paints_count;
+        m_last_cpu_time_us = cpu_time_us;
+    } );
+
+    m_render_stats_timer.start( render_stats_interval_ms );
+}
+
+void main_window::set_instant_moves( bool instant )
+{
+    m_instant_moves_action->setChecked( instant );
+}
+
 void main_window::victory( int score )
 {
     m_manager.on_victory( score );
+    m_last_score = score;
     QMessageBox::StandardButton reply;
 
     reply = QMessageBox::question( this,
-                                   "Victory!", QString{ "Your score: %1. Start new game?" }.arg( score ),
+                                   "Victory!", QString{ "Your score: %1, beats %2% of games. Start new game?" }
+                                   .arg( score ).arg( 100.0 * m_manager.fraction_below( score ), 0, 'f', 1 ),
                                    QMessageBox::Yes | QMessageBox::No );
 
     if( reply == QMessageBox::Yes )
@@ -47,18 +160,58 @@ void main_window::victory( int score )
 
 void main_window::show_scores()
 {
-    auto& scores = m_manager.get_scores();
+    std::vector< int > scores{ m_manager.get_scores() };
 
     for( int row{ 0 }; row < m_scores_widget->rowCount(); ++row )
     {
        QTableWidgetItem* item{ m_scores_widget->item( row, score_value_col ) };
-       item->setText( QString{ "%1" }.arg( scores[ m_scores_widget->rowCount() - row - 1 ] ) );
+       item->setText( static_cast< size_t >( row ) < scores.size()? QString{ "%1" }.arg( scores[ row ] ) : QString{} );
+    }
+
+    if( m_last_score )
+    {
+        statusBar()->showMessage( QString{ "Your last score %1 beats %2% of %3 games" }
+                                  .arg( m_last_score )
+                                  .arg( 100.0 * m_manager.fraction_below( m_last_score ), 0, 'f', 1 )
+                                  .arg( m_manager.games_num() ) );
     }
 
     m_scores_widget->show();
 }
 
-void main_window::create_view( model_controller& controller, const QSize& images_size )
+void main_window::show_hint( int row, int col, int clicks_left )
+{
+    statusBar()->showMessage( QString{ "Hint: click row %1, column %2 (%3 clicks left)" }
+                              .arg( row ).arg( col + 1 ).arg( clicks_left ) );
+}
+
+void main_window::show_unsolvable()
+{
+    statusBar()->showMessage( "This board has no solution" );
+}
+
+void main_window::show_input_stats( int dropped, int coalesced )
+{
+    m_input_stats_label->setText( QString{ "Dropped clicks: %1, coalesced: %2" }.arg( dropped ).arg( coalesced ) );
+}
+
+void main_window::show_seed( quint64 seed )
+{
+    m_seed_label->setText( QString{ "Seed: %1" }.arg( seed ) );
+}
+
+void main_window::show_replay_result( int score, int recorded_score )
+{
+    statusBar()->showMessage( score == recorded_score?
+                                  QString{ "Replay finished, score %1" }.arg( score ) :
+                                  QString{ "Replay finished, score %1 does not match the recorded %2" }
+                                  .arg( score ).arg( recorded_score ) );
+}
+
+void main_window::create_view( model_controller& controller,
+                               const QSize& images_size,
+                               const render_mode& mode,
+                               const repaint_mode& repaint )
 {
     qRegisterMetaType< QVector< int > >( "QVector< int >" );// for view's update slot
 
@@ -68,20 +221,83 @@ void main_window::create_view( model_controller& controller, const QSize& images
     m_game_view->setShowGrid( false );
     m_game_view->horizontalHeader()->hide();
     m_game_view->verticalHeader()->hide();
-    m_game_view->setVerticalScrollBarPolicy( Qt::ScrollBarAlwaysOff );
-    m_game_view->setHorizontalScrollBarPolicy( Qt::ScrollBarAlwaysOff );
+    m_game_view->setVerticalScrollBarPolicy( Qt::ScrollBarAsNeeded );
+    m_game_view->setHorizontalScrollBarPolicy( Qt::ScrollBarAsNeeded );
+    m_game_view->setHorizontalScrollMode( QAbstractItemView::ScrollPerPixel );
+    m_game_view->setVerticalScrollMode( QAbstractItemView::ScrollPerPixel );
     m_game_view->setFocusPolicy( Qt::NoFocus );
+    m_game_view->viewport()->installEventFilter( this );
+
+    // All cells are of the same size, so nothing has to be measured
+    m_game_view->horizontalHeader()->setSectionResizeMode( QHeaderView::Fixed );
+    m_game_view->verticalHeader()->setSectionResizeMode( QHeaderView::Fixed );
+    m_game_view->horizontalHeader()->setMinimumSectionSize( min_cell_size );
+    m_game_view->verticalHeader()->setMinimumSectionSize( min_cell_size );
 
-    graphics_delegate* del{ new graphics_delegate( images_size, *m_game_view, this ) };
-    m_game_view->setItemDelegate( del );
+    m_delegate = new graphics_delegate( images_size, mode, repaint, *m_game_view, this );
+    m_game_view->setItemDelegate( m_delegate );
 
-    connect( del, SIGNAL( animation_completed() ), &controller, SLOT( swap_animation_complete() ) );
+    connect( m_delegate,
+             SIGNAL( animation_completed( int, quint64 ) ),
+             &controller,
+             SLOT( swap_animation_complete( int, quint64 ) ) );
 
-    m_game_view->resizeColumnsToContents();
-    m_game_view->resizeRowsToContents();
+    m_images_size = images_size;
+    set_zoom( 1.0 );
+}
+
+void main_window::zoom_in()
+{
+    set_zoom( m_zoom * zoom_step );
+}
+
+void main_window::zoom_out()
+{
+    set_zoom( m_zoom / zoom_step );
+}
+
+void main_window::set_zoom( double zoom )
+{
+    double min_zoom{ static_cast< double >( min_cell_size ) /
+                     std::max( 1, std::min( m_images_size.width(), m_images_size.height() ) ) };
+    m_zoom = std::max( min_zoom, std::min( max_zoom, zoom ) );
+
+    QSize cell_size{ static_cast< int >( m_images_size.width() * m_zoom ),
+                     static_cast< int >( m_images_size.height() * m_zoom ) };
+    m_game_view->horizontalHeader()->setDefaultSectionSize( cell_size.width() );
+    m_game_view->verticalHeader()->setDefaultSectionSize( cell_size.height() );
+
+    QAbstractItemModel* model{ m_game_view->model() };
+    int frame_size{ 2 * m_game_view->frameWidth() };
+    QSize board_size{ cell_size.width() * model->columnCount() + frame_size,
+                      cell_size.height() * model->rowCount() + frame_size };
+
+    QSize screen_size{ QGuiApplication::primaryScreen()->availableGeometry().size() * max_screen_share };
+    m_game_view->setMinimumSize( board_size.boundedTo( screen_size ) );
+    m_game_view->setMaximumSize( board_size );
+}
+
+bool main_window::eventFilter( QObject* watched, QEvent* event )
+{
+    if( watched == m_game_view->viewport() && event->type() == QEvent::Wheel )
+    {
+        QWheelEvent* wheel_event{ static_cast< QWheelEvent* >( event ) };
+        if( wheel_event->modifiers() & Qt::ControlModifier )
+        {
+            if( wheel_event->angleDelta().y() > 0 )
+            {
+                zoom_in();
+            }
+            else if( wheel_event->angleDelta().y() < 0 )
+            {
+                zoom_out();
+            }
+
+            return true;
+        }
+    }
 
-    m_game_view->setFixedSize( QSize{ m_game_view->columnWidth( 0 ) * controller.get_model().columnCount() ,
-                                      m_game_view->rowHeight( 0 ) * controller.get_model().rowCount() } );
+    return QMainWindow::eventFilter( watched, event );
 }
 
 void main_window::create_menus()
@@ -89,18 +305,36 @@ void main_window::create_menus()
     m_restart_action = new QAction( "Restart", this);
     m_undo_action = new QAction( "Undo", this);
     m_redo_action = new QAction( "Redo", this);
+    m_hint_action = new QAction( "Hint", this);
+    m_auto_solve_action = new QAction( "Auto-solve", this);
     m_top_list_action = new QAction( "Scores", this);
+    m_instant_moves_action = new QAction( "Instant moves", this );
+    m_instant_moves_action->setCheckable( true );
+    m_zoom_in_action = new QAction( "Zoom in", this );
+    m_zoom_in_action->setShortcut( QKeySequence::ZoomIn );
+    m_zoom_out_action = new QAction( "Zoom out", this );
+    m_zoom_out_action->setShortcut( QKeySequence::ZoomOut );
 
     connect( m_restart_action, &QAction::triggered, this, &main_window::restart );
     connect( m_undo_action, &QAction::triggered, this, &main_window::undo );
     connect( m_redo_action, &QAction::triggered, this, &main_window::redo );
+    connect( m_hint_action, &QAction::triggered, this, &main_window::hint );
+    connect( m_auto_solve_action, &QAction::triggered, this, &main_window::auto_solve );
     connect( m_top_list_action, &QAction::triggered, this, &main_window::show_scores );
+    connect( m_instant_moves_action, &QAction::triggered, this, &main_window::instant_moves );
+    connect( m_zoom_in_action, &QAction::triggered, this, &main_window::zoom_in );
+    connect( m_zoom_out_action, &QAction::triggered, this, &main_window::zoom_out );
 
     m_menu = menuBar()->addMenu( "Menu" );
     m_menu->addAction( m_restart_action );
     m_menu->addAction( m_undo_action );
     m_menu->addAction( m_redo_action );
+    m_menu->addAction( m_hint_action );
+    m_menu->addAction( m_auto_solve_action );
     m_menu->addAction( m_top_list_action );
+    m_menu->addAction( m_instant_moves_action );
+    m_menu->addAction( m_zoom_in_action );
+    m_menu->addAction( m_zoom_out_action );
 }
 
 void main_window::create_scores_widget()
@@ -2,14 +2,19 @@
 #define MAINWINDOW_H
 
 #include <QMenu>
+#include <QTimer>
+#include <QLabel>
 #include <QAction>
 #include <QTableView>
 #include <QTableWidget>
 #include <QMainWindow>
-#include <QStandardItemModel>
+#include <QElapsedTimer>
+
+#include "common.h"
 
 class scores_manager;
 class model_controller;
+class graphics_delegate;
 
 class main_window : public QMainWindow
 {
@@ -17,36 +22,86 @@ class main_window : public QMainWindow
 
 public:
     main_window( const QSize& images_size,
+                 const render_mode& mode,
+                 const repaint_mode& repaint,
                  model_controller& controller,
                  scores_manager& manager,
                  QWidget *parent = 0 );
 
-    QTableView* get_view() const noexcept;    
+    QTableView* get_view() const noexcept;
+    graphics_delegate* get_delegate() const noexcept;
+
+    // Adds a menu entry writing the trace collected so far
+    void enable_trace_dump( const QString& file_name );
+
+    // Shows paints per second and CPU usage of the process in the status bar
+    void enable_render_stats();
+
+    // Checks the menu entry without emitting instant_moves
+    void set_instant_moves( bool instant );
+
+protected:
+    // Ctrl + wheel over the board zooms it
+    bool eventFilter( QObject* watched, QEvent* event ) override;
 
 public slots:
     void victory( int score );
     void show_scores();
+    void show_hint( int row, int col, int clicks_left );
+    void show_unsolvable();
+    void show_input_stats( int dropped, int coalesced );
+    void show_seed( quint64 seed );
+    void show_replay_result( int score, int recorded_score );
+    void zoom_in();
+    void zoom_out();
 
 signals:
     void restart();
     void undo();
     void redo();
+    void hint();
+    void auto_solve();
+    void instant_moves( bool instant );
 
 private:
-    void create_view( model_controller& controller, const QSize& images_size );
+    void create_view( model_controller& controller,
+                      const QSize& images_size,
+                      const render_mode& mode,
+                      const repaint_mode& repaint );
+    void set_zoom( double zoom );
     void create_menus();
     void create_scores_widget();
 
 private:
     scores_manager& m_manager;
     QTableView* m_game_view{ nullptr };
+    graphics_delegate* m_delegate{ nullptr };
     QTableWidget* m_scores_widget{ nullptr };
+    QLabel* m_input_stats_label{ nullptr };
+    QLabel* m_seed_label{ nullptr };
+    QLabel* m_render_stats_label{ nullptr };
+    int m_last_score{ 0 };
+
+    // Cells are image size times zoom, boards larger than the screen get scrolled
+    QSize m_images_size;
+    double m_zoom{ 1.0 };
+
+    QTimer m_render_stats_timer;
+    QElapsedTimer m_render_stats_clock;
+    uint64_t m_last_paints_count{ 0 };
+    int64_t m_last_cpu_time_us{ 0 };
 
     QMenu* m_menu{ nullptr };
     QAction* m_restart_action{ nullptr };
     QAction* m_undo_action{ nullptr };
     QAction* m_redo_action{ nullptr };
+    QAction* m_hint_action{ nullptr };
+    QAction* m_auto_solve_action{ nullptr };
     QAction* m_top_list_action{ nullptr };
+    QAction* m_instant_moves_action{ nullptr };
+    QAction* m_zoom_in_action{ nullptr };
+    QAction* m_zoom_out_action{ nullptr };
+    QAction* m_dump_trace_action{ nullptr };
 };
 
 #endif
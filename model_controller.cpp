@@ -1,236 +1,696 @@
 #include "model_controller.h"
+#include "tracing.h"
 
-#include <random>
-#include <thread>
+#include <fstream>
+#include <algorithm>
 
-model_controller::model_controller( QStandardItemModel& model,
+#include <QDateTime>
+
+model_controller::model_controller( board_model& model,
                                     size_t grid_size,
                                     size_t action_buffer_size,
+                                    const QString& bank_file_name,
+                                    const difficulty& level,
+                                    uint64_t seed,
+                                    const toggle_rule& rule,
                                     QObject* parent ) :
     QObject( parent ),
     m_model( model ),
-    m_actions( action_buffer_size )
+    m_difficulty( level ),
+    m_next_seed( seed ),
+    m_actions( action_buffer_size ),
+    m_engine( grid_size, rule ),
+    m_solver( grid_size, rule )
 {
     if( grid_size <= 0 )
     {
         throw std::invalid_argument{ "Grid size should be positive" };
     }
 
-    m_model.setRowCount( static_cast< int >( grid_size ) + 1 );
-    m_model.setColumnCount( static_cast< int >( grid_size ) );
+    if( grid_size >= max_packed_coord )
+    {
+        throw std::invalid_argument{ "Grid size should be less than 65535" };
+    }
+
+    m_model.resize( grid_size );
+    m_board.resize( grid_size );
+    m_vertical_counts.assign( grid_size, 0 );
+
+    if( rule == toggle_rule::cross )
+    {
+        open_bank( bank_file_name );
+    }
+    else if( !bank_file_name.isEmpty() )
+    {
+        throw std::invalid_argument{ "Puzzle banks only hold boards of the cross rule" };
+    }
 
     start_new_game();
 }
 
-QStandardItemModel& model_controller::get_model() const noexcept
+model_controller::~model_controller()
+{
+    // The game being played when the app is closed counts as abandoned
+    save_record();
+}
+
+void model_controller::open_bank( const QString& bank_file_name )
+{
+    // Without an explicit bank the default one is optional
+    bool required{ !bank_file_name.isEmpty() };
+    m_bank_file.setFileName( required? bank_file_name :
+                                       QString::fromStdString( get_bank_file_name( m_engine.grid_size() ) ) );
+
+    if( !m_bank_file.open( QFile::ReadOnly ) )
+    {
+        if( required )
+        {
+            throw std::invalid_argument{ "Failed to open puzzle bank" };
+        }
+
+        return;
+    }
+
+    const uchar* data{ m_bank_file.map( 0, m_bank_file.size() ) };
+    if( !data || !m_bank.open( data, static_cast< size_t >( m_bank_file.size() ), m_engine.grid_size() ) )
+    {
+        if( required )
+        {
+            throw std::invalid_argument{ "Puzzle bank does not match the grid size" };
+        }
+
+        m_bank_file.close();
+    }
+}
+
+board_model& model_controller::get_model() const noexcept
 {
     return m_model;
 }
 
+uint64_t model_controller::get_seed() const noexcept
+{
+    return m_seed;
+}
+
+void model_controller::set_replays_dir( const QString& replays_dir )
+{
+    m_replays_dir = replays_dir;
+}
+
 void model_controller::start_new_game()
 {
+    save_record();
+
     m_total_actions = 0;
+    m_auto_solving = false;
+    m_replaying = false;
+    m_inputs.clear();
+    m_actions.clear();
+
+    m_seed = m_next_seed;
+    uint64_t seed_state{ m_seed };
+    m_next_seed = splitmix64( seed_state );
+
+    m_record = replay{};
+    m_record.grid_size = static_cast< uint32_t >( m_engine.grid_size() );
+    m_record.buffer_size = static_cast< uint32_t >( m_actions.max_size() );
+    m_record.rule = m_engine.rule();
+    m_record.seed = m_seed;
+    m_record_saved = false;
+
+    // No standard distributions here, they differ between platforms
+    xoshiro256 rng{ m_seed };
+    size_t first{ 0 };
+    size_t last{ 0 };
+    if( m_bank.is_open() )
+    {
+        m_bank.get_level_range( m_difficulty, first, last );
+    }
 
-    static std::mt19937 rng{ std::random_device{}() };
-    static std::uniform_int_distribution< std::mt19937::result_type > dist{ 0, 1 };
+    // A level without puzzles gets random boards
+    if( last > first )
+    {
+        m_bank.load( first + static_cast< size_t >( rng() % ( last - first ) ), m_engine );
 
-    // Fill model with random values
-    for( int row{ 0 }; row < m_model.rowCount(); ++row )
+        // Bank boards can not be rebuilt from the seed
+        m_record.board.assign( m_engine.row_data( 0 ),
+                               m_engine.row_data( 0 ) + m_engine.grid_size() * m_engine.words_per_row() );
+    }
+    else
     {
-        for( int col{ 0 }; col < m_model.columnCount(); ++col )
-        {
-            QModelIndex index{ m_model.index( row, col ) };
+        fill_random( m_engine, rng );
+    }
+
+    show_engine_board( true );
+    emit game_started( m_seed );
+}
+
+void model_controller::start_replay( const replay& game, bool fast_forward )
+{
+    if( game.grid_size != m_engine.grid_size() || game.buffer_size != m_actions.max_size() )
+    {
+        throw std::invalid_argument{ "Replay does not match the grid or the action buffer size" };
+    }
+
+    if( game.rule != m_engine.rule() )
+    {
+        throw std::invalid_argument{ "Replay was played with another toggle rule" };
+    }
+
+    save_record();
+    m_record_saved = true;
+
+    m_total_actions = 0;
+    m_auto_solving = false;
+    m_inputs.clear();
+    m_actions.clear();
+
+    m_playback = game;
+    m_playback_pos = 0;
+    m_replaying = true;
+    m_playback.load_board( m_engine );
+
+    if( fast_forward )
+    {
+        // Only the final board is shown, locks are checked once
+        fast_forward_replay();
+        show_engine_board( false );
+        finish_replay();
+    }
+    else
+    {
+        show_engine_board( true );
+        move_completed();
+    }
+}
+
+void model_controller::show_engine_board( bool animated )
+{
+    // Whatever was being animated is dropped
+    m_move_cells.clear();
+    m_next_move_cell = 0;
+    m_swaps_to_be_completed = 0;
+
+    int grid_size{ static_cast< int >( m_engine.grid_size() ) };
 
+    // Mirror it into the board
+    for( int row{ 0 }; row < grid_size + first_switch_row_pos; ++row )
+    {
+        for( int col{ 0 }; col < grid_size; ++col )
+        {
             if( row >= first_switch_row_pos )
             {
-                data_state state{ dist( rng )?
-                                data_state::switch_vertical : data_state::switch_horizontal };
-
-                set_state( state, index );
+                swap_switch_state( pack_action( row, col ) );
             }
             else
             {
-                set_state( data_state::lock_locked, index );
+                set_state( data_state::lock_locked, row, col );
             }
         }
     }
 
+    // All locks got reset, so every column needs a check
+    m_locked_columns_num = 0;
+    m_dirty_columns.clear();
+    for( int col{ 0 }; col < grid_size; ++col )
+    {
+        m_dirty_columns.push_back( col );
+        if( m_vertical_counts[ col ] )
+        {
+            ++m_locked_columns_num;
+        }
+    }
+
+    m_solver.reset( [ this ]( size_t row, size_t col ){ return m_engine.is_vertical( row, col ); } );
+
+    m_board.animated = animated;
     update_locks();
+    m_board.animated = true;
 }
 
-void model_controller::on_click( const QModelIndex& index )
+void model_controller::fast_forward_replay()
 {
-    if( index.row() >= first_switch_row_pos && !m_swaps_to_be_completed )
+    auto click = [ this ]( const action& cell )
     {
-        ++m_total_actions;
-        m_actions.push( action{ index.row(), index.column() } );
+        m_engine.click( get_action_row( cell ) - first_switch_row_pos, get_action_col( cell ) );
+    };
+
+    for( ; m_playback_pos < m_playback.actions.size(); ++m_playback_pos )
+    {
+        input next_input{ get_replay_input( m_playback.actions[ m_playback_pos ] ) };
 
-        start_swap_switch_states( index );
+        if( next_input.type == input_type::click )
+        {
+            ++m_total_actions;
+            m_actions.push( next_input.cell );
+            click( next_input.cell );
+        }
+        else if( next_input.type == input_type::undo && m_actions.has_prev() )
+        {
+            --m_total_actions;
+            click( m_actions.prev() );
+        }
+        else if( next_input.type == input_type::redo && m_actions.has_next() )
+        {
+            ++m_total_actions;
+            click( m_actions.next() );
+        }
     }
 }
 
-void model_controller::undo()
+void model_controller::finish_replay()
 {
-    if( m_actions.has_prev() && !m_swaps_to_be_completed )
-    {
-        --m_total_actions;
+    m_replaying = false;
+    emit replay_finished( m_locked_columns_num? 0 : static_cast< int >( calc_score() ),
+                          static_cast< int >( m_playback.score ) );
+}
+
+model_controller::input model_controller::get_replay_input( replay_action replay_input ) const noexcept
+{
+    uint32_t cell{ get_replay_action_cell( replay_input ) };
+    uint32_t grid_size{ static_cast< uint32_t >( m_engine.grid_size() ) };
 
-        const action& prev = m_actions.prev();
-        QModelIndex index{ m_model.index( prev.first, prev.second ) };
-        start_swap_switch_states( index );
+    switch( get_replay_action_kind( replay_input ) )
+    {
+    case replay_action_kind::undo: return { input_type::undo, 0 };
+    case replay_action_kind::redo: return { input_type::redo, 0 };
+    default: return { input_type::click, pack_action( cell / grid_size + first_switch_row_pos, cell % grid_size ) };
     }
 }
 
-void model_controller::redo()
+void model_controller::record_action( const replay_action_kind& kind, const action& cell )
+{
+    uint32_t grid_size{ static_cast< uint32_t >( m_engine.grid_size() ) };
+    uint32_t cell_pos{ kind == replay_action_kind::click?
+                ( get_action_row( cell ) - first_switch_row_pos ) * grid_size + get_action_col( cell ) : 0 };
+
+    m_record.actions.push_back( make_replay_action( kind, cell_pos ) );
+}
+
+void model_controller::save_record()
 {
-    if( m_actions.has_next() && !m_swaps_to_be_completed )
+    if( m_replays_dir.isEmpty() || m_record_saved || m_replaying || m_record.actions.empty() )
     {
-        ++m_total_actions;
+        return;
+    }
+
+    m_record_saved = true;
+
+    QString file_name{ QString{ "%1/%2_%3.replay" }.arg( m_replays_dir )
+                                                  .arg( m_record.seed )
+                                                  .arg( QDateTime::currentMSecsSinceEpoch() ) };
+
+    std::ofstream out{ file_name.toStdString(), std::ios::binary | std::ios::trunc };
+    try
+    {
+        write_replay( out, m_record );
+    }
+    catch( const std::exception& e )
+    {
+        // Losing a replay is not worth stopping the game
+        qWarning( "Failed to save replay: %s", e.what() );
+    }
+}
+
+void model_controller::on_click( const QModelIndex& index )
+{
+    TRACE_SCOPE( "on_click" );
 
-        const action& prev = m_actions.next();
-        QModelIndex index{ m_model.index( prev.first, prev.second ) };
-        start_swap_switch_states( index );
+    if( index.row() >= first_switch_row_pos )
+    {
+        process_input( { input_type::click, pack_action( index.row(), index.column() ) } );
     }
 }
 
-void model_controller::maybe_add_child( const QModelIndex& index, const move_direction& direction )
+void model_controller::undo()
+{
+    process_input( { input_type::undo, 0 } );
+}
+
+void model_controller::redo()
 {
-    if( direction == move_direction::left && index.column() - 1 >= 0 )
+    process_input( { input_type::redo, 0 } );
+}
+
+void model_controller::hint()
+{
+    // Boards of other rules may be too large to solve, there is just no hint then
+    if( !m_solver.is_supported() )
+    {
+        return;
+    }
+
+    size_t row{ 0 };
+    size_t col{ 0 };
+
+    if( m_solver.get_hint( row, col ) )
+    {
+        emit hint_ready( static_cast< int >( row ) + first_switch_row_pos,
+                         static_cast< int >( col ),
+                         static_cast< int >( m_solver.solution_size() ) );
+    }
+    else if( !m_solver.is_solvable() )
     {
-        m_swap_queue.push_back( { m_model.index( index.row(), index.column() - 1 ),
-                           direction } );
+        emit unsolvable();
     }
-    else if( direction == move_direction::right &&
-             index.column() + 1 < m_model.columnCount() )
+}
+
+void model_controller::auto_solve()
+{
+    if( !m_solver.is_supported() )
     {
-        m_swap_queue.push_back( { m_model.index( index.row(), index.column() + 1 ),
-                           direction } );
+        return;
     }
-    else if( direction == move_direction::top && index.row() - 1 > lock_row_pos )
+
+    if( !m_solver.is_solvable() )
     {
-        m_swap_queue.push_back( { m_model.index( index.row() - 1, index.column() ),
-                           direction } );
+        emit unsolvable();
+        return;
     }
-    else if( direction == move_direction::bottom &&
-             index.row() + 1 < m_model.rowCount() )
+
+    m_auto_solving = true;
+    if( !m_swaps_to_be_completed )
     {
-        m_swap_queue.push_back( { m_model.index( index.row() + 1, index.column() ),
-                           direction } );
+        move_completed();
     }
 }
 
-uint16_t get_distance_from_root( const QPair< int, int >& root, const QModelIndex& curr )
+void model_controller::set_instant_moves( bool instant )
 {
-    return root.first == curr.row()?
-                std::abs( root.second - curr.column() ) :
-                std::abs( root.first - curr.row() );
+    m_instant_moves = instant;
 }
 
-void model_controller::start_swap_switch_states( const QModelIndex& start_index )
+void model_controller::start_swap_switch_states( const action& start_cell )
 {
-    maybe_add_child( start_index, move_direction::left );
-    maybe_add_child( start_index, move_direction::right );
-    maybe_add_child( start_index, move_direction::top );
-    maybe_add_child( start_index, move_direction::bottom );
+    TRACE_SCOPE( "start_swap_switch_states" );
 
-    m_last_distance_from_root = 1;
+    if( tracer::is_enabled() )
+    {
+        m_move_begin_ns = tracer::now_ns();
+    }
+
+    size_t row{ get_action_row( start_cell ) - first_switch_row_pos };
+    size_t col{ get_action_col( start_cell ) };
+
+    m_engine.click( row, col );
+    m_solver.on_click( row, col );
+    m_engine.toggled_cells( row, col, m_move_cells );
+
+    if( m_instant_moves )
+    {
+        swap_move_cells();
+        return;
+    }
+
+    m_next_move_cell = 1;
     m_swaps_to_be_completed = 1;
-    m_current_root = { start_index.row(), start_index.column() };
 
-    swap_switch_state( start_index );
+    // The engine has taken the whole move, the board catches up wave by wave
+    swap_switch_state( start_cell );
+    publish_board();
+    m_move_generation = m_board.generation;
 }
 
-void model_controller::swap_animation_complete()
+void model_controller::swap_move_cells()
 {
-    if( m_swaps_to_be_completed )
+    for( const toggled_cell& cell : m_move_cells )
     {
-        --m_swaps_to_be_completed;
+        swap_switch_state( pack_action( cell.row + first_switch_row_pos, cell.col ) );
+    }
+
+    m_next_move_cell = m_move_cells.size();
+
+    // Victory is checked right away, animations only catch up on screen
+    update_locks();
+
+    if( m_move_begin_ns && tracer::is_enabled() )
+    {
+        tracer::record( "move", m_move_begin_ns, tracer::now_ns() );
+        m_move_begin_ns = 0;
+    }
+}
+
+void model_controller::swap_animation_complete( int count, quint64 generation )
+{
+    // Late animations of instant or dropped moves must not advance this move's waves
+    if( m_swaps_to_be_completed && generation >= m_move_generation )
+    {
+        m_swaps_to_be_completed -= std::min< uint16_t >( m_swaps_to_be_completed, count );
         if( !m_swaps_to_be_completed )
         {
-            while( !m_swap_queue.empty() )
-            {
-                auto& index_and_direction = m_swap_queue.front();
+            TRACE_SCOPE( "wave" );
 
-                // Every time we increase the dist from root, wait for animation to finish
-                int curr_distance{ get_distance_from_root( m_current_root, index_and_direction.first ) };
-                if( curr_distance > m_last_distance_from_root )
-                {
-                    m_last_distance_from_root = curr_distance;
-                    break;
-                }
+            // Every time we increase the dist from root, wait for animation to finish
+            uint32_t distance{ m_next_move_cell < m_move_cells.size()? m_move_cells[ m_next_move_cell ].distance : 0 };
+            for( ; m_next_move_cell < m_move_cells.size() &&
+                   m_move_cells[ m_next_move_cell ].distance == distance; ++m_next_move_cell )
+            {
+                const toggled_cell& cell = m_move_cells[ m_next_move_cell ];
 
                 ++m_swaps_to_be_completed;
-
-                swap_switch_state( index_and_direction.first );
-                maybe_add_child( index_and_direction.first, index_and_direction.second );
-
-                m_swap_queue.pop_front();
+                swap_switch_state( pack_action( cell.row + first_switch_row_pos, cell.col ) );
             }
 
             update_locks();
+
+            if( !m_swaps_to_be_completed )
+            {
+                // Whole move, from the click being played to the last lock update
+                if( m_move_begin_ns && tracer::is_enabled() )
+                {
+                    tracer::record( "move", m_move_begin_ns, tracer::now_ns() );
+                    m_move_begin_ns = 0;
+                }
+
+                move_completed();
+            }
         }
     }
 }
 
-void model_controller::set_state( const data_state& state, const QModelIndex& index )
+void model_controller::set_state( const data_state& state, int row, int col )
 {
-    m_model.setData( index, as_int( state ), Qt::UserRole );
-    emit index_changed( index );
+    m_board.set_state( state, row, col );
+}
+
+void model_controller::publish_board()
+{
+    // Whole wave goes out as one board and one queued signal
+    if( m_board.changed.empty() )
+    {
+        return;
+    }
+
+    ++m_board.generation;
+    m_model.publish( m_board );
+    m_board.changed = board_area{};
+    m_board.changed_switches = 0;
+
+    emit board_published();
 }
 
-void model_controller::swap_switch_state( const QModelIndex& index )
+void model_controller::swap_switch_state( const action& cell )
 {
-    auto curr_state = as_enum< data_state >( index.data( Qt::UserRole ).toInt() );
-    data_state new_state{ curr_state == data_state::switch_horizontal?
-                    data_state::switch_vertical : data_state::switch_horizontal };
+    int row{ static_cast< int >( get_action_row( cell ) ) };
+    int col{ static_cast< int >( get_action_col( cell ) ) };
+    bool vertical{ m_engine.is_vertical( static_cast< size_t >( row - first_switch_row_pos ),
+                                         static_cast< size_t >( col ) ) };
 
-    set_state( new_state, index );
+    bool was_vertical{ m_board.state( row, col ) == data_state::switch_vertical };
+    if( vertical != was_vertical )
+    {
+        uint32_t& count = m_vertical_counts[ col ];
+        count = vertical? count + 1 : count - 1;
+
+        if( count == ( vertical? 1 : 0 ) )
+        {
+            m_locked_columns_num = vertical? m_locked_columns_num + 1 : m_locked_columns_num - 1;
+            m_dirty_columns.push_back( col );
+        }
+    }
+
+    set_state( vertical? data_state::switch_vertical : data_state::switch_horizontal, row, col );
 }
 
 uint32_t model_controller::calc_score() const noexcept
 {
-    return double( m_model.columnCount() * 100 ) / m_total_actions;
+    return ::calc_score( m_engine.grid_size(), m_total_actions );
 }
 
 void model_controller::update_locks()
 {
-    uint16_t unlocked_locks_num{ 0 };
+    TRACE_SCOPE( "update_locks" );
 
-    for( int col{ 0 }; col < m_model.columnCount(); ++col )
+    for( int col : m_dirty_columns )
     {
-        bool has_vertical_switches{ false };
-        for( int row{ first_switch_row_pos }; row < m_model.rowCount(); ++row )
+        bool has_vertical_switches{ m_vertical_counts[ col ] > 0 };
+        data_state lock_state{ m_board.state( lock_row_pos, col ) };
+
+        if( has_vertical_switches && lock_state == data_state::lock_unlocked )
         {
-            QModelIndex index{ m_model.index( row, col ) };
-            auto switch_state = as_enum< data_state >( index.data( Qt::UserRole ).toInt() );
+            set_state( data_state::lock_locked, lock_row_pos, col );
+        }
+        else if( !has_vertical_switches && lock_state == data_state::lock_locked )
+        {
+            set_state( data_state::lock_unlocked, lock_row_pos, col );
+        }
+    }
 
-            if( switch_state == data_state::switch_vertical )
-            {
-                has_vertical_switches = true;
-                break;
-            }
+    m_dirty_columns.clear();
+    publish_board();
+
+    // Shown switches match the engine once the wave is over
+    if( !m_swaps_to_be_completed && !m_locked_columns_num && !m_replaying )
+    {
+        m_record.score = calc_score();
+        save_record();
+
+        emit victory( calc_score() );
+    }
+}
+
+void model_controller::move_completed()
+{
+    while( !m_inputs.empty() )
+    {
+        if( play_input( m_inputs.dequeue() ) )
+        {
+            return;
         }
+    }
 
-        QModelIndex index{ m_model.index( lock_row_pos, col ) };
-        auto lock_state = as_enum< data_state >( index.data( Qt::UserRole ).toInt() );
+    // Replays feed the next action once the previous move is over
+    while( m_replaying )
+    {
+        if( m_playback_pos == m_playback.actions.size() )
+        {
+            finish_replay();
+            return;
+        }
 
-        if( has_vertical_switches && lock_state == data_state::lock_unlocked )
+        if( play_input( get_replay_input( m_playback.actions[ m_playback_pos++ ] ) ) )
         {
-            set_state( data_state::lock_locked, index );
+            return;
         }
-        else if( !has_vertical_switches && lock_state == data_state::lock_locked )
+    }
+
+    size_t row{ 0 };
+    size_t col{ 0 };
+
+    while( m_auto_solving && m_solver.get_hint( row, col ) )
+    {
+        if( play_input( { input_type::click, pack_action( row + first_switch_row_pos, col ) } ) )
         {
-            set_state( data_state::lock_unlocked, index );
+            return;
         }
+    }
+
+    m_auto_solving = false;
+}
+
+void model_controller::process_input( const input& new_input )
+{
+    if( m_replaying )
+    {
+        return;
+    }
+
+    if( m_swaps_to_be_completed )
+    {
+        queue_input( new_input );
+    }
+    else
+    {
+        play_input( new_input );
+    }
+}
+
+void model_controller::queue_input( const input& new_input )
+{
+    static constexpr int max_queued_inputs{ 64 };
+
+    if( !m_inputs.empty() && m_inputs.back().type == input_type::click )
+    {
+        input& last_input = m_inputs.back();
 
-        if( !has_vertical_switches )
+        if( new_input.type == input_type::click && new_input.cell == last_input.cell )
         {
-            ++unlocked_locks_num;
+            last_input.type = input_type::double_click;
+            ++m_coalesced_inputs;
+            emit input_stats( m_dropped_inputs, m_coalesced_inputs );
+            return;
+        }
+        else if( new_input.type == input_type::undo )
+        {
+            last_input.type = input_type::click_undo;
+            ++m_coalesced_inputs;
+            emit input_stats( m_dropped_inputs, m_coalesced_inputs );
+            return;
         }
     }
 
-    if( unlocked_locks_num == m_model.columnCount() )
+    if( m_inputs.size() < max_queued_inputs )
     {
-        emit victory( calc_score() );
+        m_inputs.enqueue( new_input );
+    }
+    else
+    {
+        ++m_dropped_inputs;
+        emit input_stats( m_dropped_inputs, m_coalesced_inputs );
+    }
+}
+
+bool model_controller::play_input( const input& next_input )
+{
+    // Returns whether a move is being animated, instant moves are over on return
+    switch( next_input.type )
+    {
+    case input_type::click:
+        ++m_total_actions;
+        m_actions.push( next_input.cell );
+        record_action( replay_action_kind::click, next_input.cell );
+        start_swap_switch_states( next_input.cell );
+        return m_swaps_to_be_completed > 0;
+
+    case input_type::undo:
+        if( !m_actions.has_prev() )
+        {
+            return false;
+        }
+
+        --m_total_actions;
+        record_action( replay_action_kind::undo, 0 );
+        start_swap_switch_states( m_actions.prev() );
+        return m_swaps_to_be_completed > 0;
+
+    case input_type::redo:
+        if( !m_actions.has_next() )
+        {
+            return false;
+        }
+
+        ++m_total_actions;
+        record_action( replay_action_kind::redo, 0 );
+        start_swap_switch_states( m_actions.next() );
+        return m_swaps_to_be_completed > 0;
+
+    case input_type::double_click:
+        // Same cell twice leaves the board as it was, only the history changes
+        m_total_actions += 2;
+        m_actions.push( next_input.cell );
+        m_actions.push( next_input.cell );
+        record_action( replay_action_kind::click, next_input.cell );
+        record_action( replay_action_kind::click, next_input.cell );
+        return false;
+
+    case input_type::click_undo:
+        m_actions.push( next_input.cell );
+        m_actions.prev();
+        record_action( replay_action_kind::click, next_input.cell );
+        record_action( replay_action_kind::undo, 0 );
+        return false;
     }
+
+    return false;
 }
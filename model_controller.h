@@ -1,51 +1,127 @@
 #ifndef MODEL_CONTROLLER_H
 #define MODEL_CONTROLLER_H
 
+#include <QFile>
 #include <QQueue>
-#include <QStandardItemModel>
 
 #include "common.h"
+#include "solver.h"
+#include "game_engine.h"
+#include "puzzle_bank.h"
+#include "replay.h"
+#include "board_model.h"
+#include "board_snapshot.h"
 #include "traversible_circular_buffer.h"
 
-// Manages switches' and locks' states
+// Plays moves on the game engine and mirrors switches' and locks' states into its own board,
+// which is published to the model after every change
 
 class model_controller : public QObject
 {
     Q_OBJECT
 
-    using action = QPair< int, int >;
-    enum class move_direction{ left, right, top, bottom };
+    // Benchmarks time the private steps of a move
+    friend class controller_benchmark;
+
+    using action = packed_action;
+
+    // Inputs arriving while a move is animated wait in a queue,
+    // pairs cancelling each other out are merged and never animated
+    enum class input_type{ click, undo, redo, double_click, click_undo };
+    struct input
+    {
+        input_type type;
+        action cell;
+    };
 
 public:
-    model_controller( QStandardItemModel& model,
+    model_controller( board_model& model,
                       size_t grid_size,
                       size_t action_buffer_size,
+                      const QString& bank_file_name,
+                      const difficulty& level,
+                      uint64_t seed,
+                      const toggle_rule& rule = toggle_rule::cross,
                       QObject* parent = nullptr );
+    ~model_controller() override;
+
+    board_model& get_model() const noexcept;
+    uint64_t get_seed() const noexcept;
+
+    // Finished and abandoned games get written there, nothing is recorded if it is empty
+    void set_replays_dir( const QString& replays_dir );
 
-    QStandardItemModel& get_model() const noexcept;
+    // Plays a replay instead of user input, at animation speed or all at once
+    void start_replay( const replay& game, bool fast_forward );
 
 public slots:
     void start_new_game();
     void on_click( const QModelIndex& index );
     void undo();
     void redo();
+    void hint();
+    void auto_solve();
 
-    void swap_animation_complete();
+    void swap_animation_complete( int count, quint64 generation );
+
+    // Instant moves show all flipped switches at once and never wait for animations,
+    // takes effect from the next move
+    void set_instant_moves( bool instant );
 
 signals:
-    void index_changed( const QModelIndex& );
+    void board_published();
+    void game_started( quint64 seed );
+    void replay_finished( int score, int recorded_score );
     void victory( int score );
+    void hint_ready( int row, int col, int clicks_left );
+    void unsolvable();
+    void input_stats( int dropped, int coalesced );
 
 private:
+    void open_bank( const QString& bank_file_name );
+    void show_engine_board( bool animated );
+    void record_action( const replay_action_kind& kind, const action& cell );
+    void save_record();
+    void fast_forward_replay();
+    void finish_replay();
+    input get_replay_input( replay_action replay_input ) const noexcept;
     void update_locks();
+    void move_completed();
+    void process_input( const input& new_input );
+    void queue_input( const input& new_input );
+    bool play_input( const input& next_input );
     uint32_t calc_score() const noexcept;
-    void swap_switch_state( const QModelIndex& index );
-    void start_swap_switch_states( const QModelIndex& start_index );
-    void set_state( const data_state& state, const QModelIndex& index );
-    void maybe_add_child( const QModelIndex& index, const move_direction& direction );
+    void publish_board();
+    void swap_switch_state( const action& cell );
+    void start_swap_switch_states( const action& start_cell );
+    void swap_move_cells();
+    void set_state( const data_state& state, int row, int col );
 
 private:
-    QStandardItemModel& m_model;
+    board_model& m_model;
+
+    // Board being shown, switches catch up with the engine wave by wave
+    board_snapshot m_board;
+
+    // New games come from the mapped bank if there is one, random boards otherwise.
+    // Banks only hold cross boards
+    QFile m_bank_file;
+    puzzle_bank m_bank;
+    difficulty m_difficulty{ difficulty::normal };
+
+    // Every game is built from its own seed, the next one is derived from it
+    uint64_t m_seed{ 0 };
+    uint64_t m_next_seed{ 0 };
+
+    // Current game as it is being played
+    QString m_replays_dir;
+    replay m_record;
+    bool m_record_saved{ false };
+
+    // Replay fed instead of user input
+    replay m_playback;
+    size_t m_playback_pos{ 0 };
+    bool m_replaying{ false };
 
     // For score calculation
     uint32_t m_total_actions{ 1 };
@@ -53,11 +129,34 @@ private:
     // Action buffer for undo/redo
     traversible_circular_buffer< action > m_actions;
 
-    // Data required to switch switches (ugh) sequentially
-    QPair< int, int > m_current_root{};
+    // Board state with every started move applied
+    game_engine m_engine;
+
+    // Vertical switches shown in each column, locks are only re-checked
+    // for the columns whose count crossed zero
+    std::vector< uint32_t > m_vertical_counts;
+    std::vector< int > m_dirty_columns;
+    size_t m_locked_columns_num{ 0 };
+
+    // Inputs waiting for the current move to finish
+    QQueue< input > m_inputs;
+    uint32_t m_dropped_inputs{ 0 };
+    uint32_t m_coalesced_inputs{ 0 };
+
+    // Keeps the shortest known solution up to date after every move
+    solver m_solver;
+    bool m_auto_solving{ false };
+
+    // Switches flipped by the current move ordered by distance from the clicked one,
+    // every wave shows the ones at the next distance
+    std::vector< toggled_cell > m_move_cells;
+    size_t m_next_move_cell{ 0 };
     uint16_t m_swaps_to_be_completed{ 0 };
-    uint16_t m_last_distance_from_root{ 0 };
-    QQueue< QPair< QModelIndex, move_direction > > m_swap_queue;
+    bool m_instant_moves{ false };
+
+    // First board generation of the current move, animations of older ones are not waited for
+    uint64_t m_move_generation{ 0 };
+    uint64_t m_move_begin_ns{ 0 };
 };
 
 #endif
@@ -0,0 +1,135 @@
+#include "puzzle_bank.h"
+
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+static constexpr uint32_t bank_magic{ 0x4b424b4c }; // "LKBK"
+static constexpr uint32_t bank_version{ 1 };
+
+difficulty get_difficulty( const std::string& name )
+{
+    if( name == "easy" )
+    {
+        return difficulty::easy;
+    }
+    else if( name == "normal" )
+    {
+        return difficulty::normal;
+    }
+    else if( name == "hard" )
+    {
+        return difficulty::hard;
+    }
+
+    throw std::invalid_argument{ "Difficulty should be one of: easy, normal, hard" };
+}
+
+std::string get_bank_file_name( size_t grid_size )
+{
+    return "puzzles_" + std::to_string( grid_size ) + ".bank";
+}
+
+bool puzzle_bank::open( const unsigned char* data, size_t size, size_t grid_size )
+{
+    m_boards = nullptr;
+
+    if( size < sizeof( puzzle_bank_header ) )
+    {
+        return false;
+    }
+
+    std::memcpy( &m_header, data, sizeof( puzzle_bank_header ) );
+    if( m_header.magic != bank_magic || m_header.version != bank_version ||
+        m_header.grid_size != grid_size || !m_header.puzzles_num )
+    {
+        return false;
+    }
+
+    size_t words_per_row{ ( grid_size + game_engine::bits_per_word - 1 ) / game_engine::bits_per_word };
+    m_board_words = grid_size * words_per_row;
+
+    size_t offsets_size{ ( m_header.max_length + size_t{ 2 } ) * sizeof( uint64_t ) };
+    size_t boards_pos{ sizeof( puzzle_bank_header ) + offsets_size };
+    if( size < boards_pos || ( size - boards_pos ) / sizeof( uint64_t ) / m_board_words < m_header.puzzles_num )
+    {
+        return false;
+    }
+
+    m_length_offsets.resize( m_header.max_length + size_t{ 2 } );
+    std::memcpy( m_length_offsets.data(), data + sizeof( puzzle_bank_header ), offsets_size );
+    m_boards = data + boards_pos;
+
+    return true;
+}
+
+bool puzzle_bank::is_open() const noexcept
+{
+    return m_boards;
+}
+
+size_t puzzle_bank::puzzles_num() const noexcept
+{
+    return is_open()? m_header.puzzles_num : 0;
+}
+
+size_t puzzle_bank::solution_length( size_t puzzle ) const noexcept
+{
+    auto it = std::upper_bound( m_length_offsets.begin(), m_length_offsets.end(), puzzle );
+    return static_cast< size_t >( it - m_length_offsets.begin() ) - 1;
+}
+
+void puzzle_bank::get_level_range( const difficulty& level, size_t& first, size_t& last ) const noexcept
+{
+    size_t level_pos{ static_cast< size_t >( level ) };
+    first = puzzles_num() * level_pos / difficulty_levels;
+    last = puzzles_num() * ( level_pos + 1 ) / difficulty_levels;
+
+    // Tiny banks still give every level something to play
+    if( first == last )
+    {
+        last = std::min( first + 1, puzzles_num() );
+        if( first == last && first )
+        {
+            --first;
+        }
+    }
+}
+
+void puzzle_bank::load( size_t puzzle, game_engine& engine ) const noexcept
+{
+    std::memcpy( engine.row_data( 0 ),
+                 m_boards + puzzle * m_board_words * sizeof( uint64_t ),
+                 m_board_words * sizeof( uint64_t ) );
+}
+
+void write_puzzle_bank( std::ostream& out,
+                        size_t grid_size,
+                        const std::vector< uint32_t >& lengths,
+                        const std::vector< uint64_t >& boards )
+{
+    puzzle_bank_header header;
+    header.magic = bank_magic;
+    header.version = bank_version;
+    header.grid_size = static_cast< uint32_t >( grid_size );
+    header.max_length = lengths.empty()? 0 : lengths.back();
+    header.puzzles_num = lengths.size();
+
+    std::vector< uint64_t > length_offsets( header.max_length + size_t{ 2 } );
+    for( size_t length{ 0 }; length < length_offsets.size(); ++length )
+    {
+        length_offsets[ length ] = static_cast< uint64_t >(
+                    std::lower_bound( lengths.begin(), lengths.end(), length ) - lengths.begin() );
+    }
+
+    out.write( reinterpret_cast< const char* >( &header ), sizeof( header ) );
+    out.write( reinterpret_cast< const char* >( length_offsets.data() ),
+               static_cast< std::streamsize >( length_offsets.size() * sizeof( uint64_t ) ) );
+    out.write( reinterpret_cast< const char* >( boards.data() ),
+               static_cast< std::streamsize >( boards.size() * sizeof( uint64_t ) ) );
+
+    if( !out )
+    {
+        throw std::ios_base::failure{ "Failed to write puzzle bank" };
+    }
+}
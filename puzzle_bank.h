@@ -0,0 +1,61 @@
+#ifndef PUZZLE_BANK_H
+#define PUZZLE_BANK_H
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+
+#include "game_engine.h"
+
+// Pregenerated puzzles of one grid size sorted by their minimum solution length.
+// File layout: header, first puzzle index of every solution length from 0 to max_length + 1,
+// then the boards, each one is grid_size rows of game_engine words.
+
+enum class difficulty{ easy, normal, hard };
+static constexpr size_t difficulty_levels{ 3 };
+
+difficulty get_difficulty( const std::string& name );
+std::string get_bank_file_name( size_t grid_size );
+
+struct puzzle_bank_header
+{
+    uint32_t magic{ 0 };
+    uint32_t version{ 0 };
+    uint32_t grid_size{ 0 };
+    uint32_t max_length{ 0 };
+    uint64_t puzzles_num{ 0 };
+};
+
+// Read-only view over a bank, usually a mapped file which should outlive it
+class puzzle_bank
+{
+public:
+    // Returns false if the data is not a bank of the grid size
+    bool open( const unsigned char* data, size_t size, size_t grid_size );
+    bool is_open() const noexcept;
+
+    size_t puzzles_num() const noexcept;
+    size_t solution_length( size_t puzzle ) const noexcept;
+
+    // Difficulty levels split the puzzles sorted by solution length into equal parts,
+    // every level of an open bank gets at least one puzzle
+    void get_level_range( const difficulty& level, size_t& first, size_t& last ) const noexcept;
+
+    void load( size_t puzzle, game_engine& engine ) const noexcept;
+
+private:
+    puzzle_bank_header m_header;
+    size_t m_board_words{ 0 };
+    std::vector< uint64_t > m_length_offsets;
+    const unsigned char* m_boards{ nullptr };
+};
+
+// Boards should be sorted by lengths, grid_size * words_per_row words each
+void write_puzzle_bank( std::ostream& out,
+                        size_t grid_size,
+                        const std::vector< uint32_t >& lengths,
+                        const std::vector< uint64_t >& boards );
+
+#endif
@@ -0,0 +1,219 @@
+#include "replay.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "traversible_circular_buffer.h"
+
+static constexpr char replay_magic[]{ 'L', 'K', 'R', 'P' };
+static constexpr uint64_t replay_version{ 2 };
+static constexpr uint64_t first_version_with_rule{ 2 };
+
+static void write_varint( std::ostream& out, uint64_t value )
+{
+    char bytes[ 10 ];
+    size_t size{ 0 };
+
+    do
+    {
+        bytes[ size ] = static_cast< char >( ( value & 0x7f ) | ( value > 0x7f? 0x80 : 0 ) );
+        value >>= 7;
+        ++size;
+    }
+    while( value );
+
+    out.write( bytes, static_cast< std::streamsize >( size ) );
+}
+
+static uint64_t read_varint( std::istream& in )
+{
+    uint64_t value{ 0 };
+
+    for( int shift{ 0 }; shift < 64; shift += 7 )
+    {
+        int byte{ in.get() };
+        if( byte == std::char_traits< char >::eof() )
+        {
+            throw std::invalid_argument{ "Replay is truncated" };
+        }
+
+        value |= uint64_t( byte & 0x7f ) << shift;
+        if( !( byte & 0x80 ) )
+        {
+            return value;
+        }
+    }
+
+    throw std::invalid_argument{ "Replay has a malformed number" };
+}
+
+void replay::load_board( game_engine& engine ) const
+{
+    engine = game_engine{ grid_size, rule };
+
+    if( board.empty() )
+    {
+        xoshiro256 rng{ seed };
+        fill_random( engine, rng );
+    }
+    else
+    {
+        std::copy( board.begin(), board.end(), engine.row_data( 0 ) );
+    }
+}
+
+void write_replay( std::ostream& out, const replay& game )
+{
+    out.write( replay_magic, sizeof( replay_magic ) );
+    write_varint( out, replay_version );
+    write_varint( out, game.grid_size );
+    write_varint( out, game.buffer_size );
+    write_varint( out, static_cast< uint64_t >( game.rule ) );
+    write_varint( out, game.seed );
+
+    write_varint( out, game.board.size() );
+    for( uint64_t word : game.board )
+    {
+        char bytes[ sizeof( word ) ];
+        for( size_t byte{ 0 }; byte < sizeof( word ); ++byte )
+        {
+            bytes[ byte ] = static_cast< char >( word >> ( 8 * byte ) );
+        }
+
+        out.write( bytes, sizeof( bytes ) );
+    }
+
+    for( replay_action action : game.actions )
+    {
+        write_varint( out, action );
+    }
+
+    write_varint( out, make_replay_action( replay_action_kind::end, 0 ) );
+    write_varint( out, game.score );
+
+    if( !out )
+    {
+        throw std::ios_base::failure{ "Failed to write replay" };
+    }
+}
+
+replay read_replay( std::istream& in )
+{
+    char magic[ sizeof( replay_magic ) ]{};
+    if( !in.read( magic, sizeof( magic ) ) || !std::equal( magic, magic + sizeof( magic ), replay_magic ) )
+    {
+        throw std::invalid_argument{ "Not a replay" };
+    }
+
+    uint64_t version{ read_varint( in ) };
+    if( !version || version > replay_version )
+    {
+        throw std::invalid_argument{ "Unsupported replay version" };
+    }
+
+    replay game;
+    game.grid_size = static_cast< uint32_t >( read_varint( in ) );
+    game.buffer_size = static_cast< uint32_t >( read_varint( in ) );
+
+    if( version >= first_version_with_rule )
+    {
+        uint64_t rule{ read_varint( in ) };
+        if( rule > static_cast< uint64_t >( toggle_rule::radius3 ) )
+        {
+            throw std::invalid_argument{ "Replay has an unknown toggle rule" };
+        }
+
+        game.rule = static_cast< toggle_rule >( rule );
+    }
+
+    game.seed = read_varint( in );
+
+    if( !game.grid_size || !game.buffer_size )
+    {
+        throw std::invalid_argument{ "Replay has an empty grid or buffer" };
+    }
+
+    uint64_t board_words{ read_varint( in ) };
+    uint64_t words_per_row{ ( game.grid_size + game_engine::bits_per_word - 1 ) / game_engine::bits_per_word };
+    if( board_words && board_words != game.grid_size * words_per_row )
+    {
+        throw std::invalid_argument{ "Replay board does not match its grid size" };
+    }
+
+    game.board.resize( board_words );
+    for( uint64_t& word : game.board )
+    {
+        unsigned char bytes[ sizeof( word ) ];
+        if( !in.read( reinterpret_cast< char* >( bytes ), sizeof( bytes ) ) )
+        {
+            throw std::invalid_argument{ "Replay is truncated" };
+        }
+
+        word = 0;
+        for( size_t byte{ 0 }; byte < sizeof( word ); ++byte )
+        {
+            word |= uint64_t{ bytes[ byte ] } << ( 8 * byte );
+        }
+    }
+
+    uint64_t cells_num{ uint64_t{ game.grid_size } * game.grid_size };
+    for( replay_action action{ static_cast< replay_action >( read_varint( in ) ) };
+         get_replay_action_kind( action ) != replay_action_kind::end;
+         action = static_cast< replay_action >( read_varint( in ) ) )
+    {
+        if( get_replay_action_cell( action ) >= cells_num )
+        {
+            throw std::invalid_argument{ "Replay clicks outside of the grid" };
+        }
+
+        game.actions.push_back( action );
+    }
+
+    game.score = static_cast< uint32_t >( read_varint( in ) );
+
+    return game;
+}
+
+replay_result play_replay( const replay& game )
+{
+    game_engine engine;
+    game.load_board( engine );
+
+    traversible_circular_buffer< uint32_t > actions{ game.buffer_size };
+    replay_result result;
+
+    auto click = [ &engine, &game ]( uint32_t cell )
+    {
+        engine.click( cell / game.grid_size, cell % game.grid_size );
+    };
+
+    for( replay_action action : game.actions )
+    {
+        switch( get_replay_action_kind( action ) )
+        {
+        case replay_action_kind::click:
+            ++result.total_actions;
+            actions.push( get_replay_action_cell( action ) );
+            click( get_replay_action_cell( action ) );
+            break;
+
+        case replay_action_kind::undo:
+            --result.total_actions;
+            click( actions.prev() );
+            break;
+
+        case replay_action_kind::redo:
+            ++result.total_actions;
+            click( actions.next() );
+            break;
+
+        case replay_action_kind::end:
+            break;
+        }
+    }
+
+    result.solved = engine.is_solved();
+    result.score = result.solved? calc_score( game.grid_size, result.total_actions ) : 0;
+
+    return result;
+}
@@ -0,0 +1,64 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <vector>
+#include <istream>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+
+#include "game_engine.h"
+
+// Recorded game: the starting board and every action applied to the undo/redo buffer.
+// File layout: magic, then varints: version, grid size, buffer size, toggle rule (since version 2,
+// older replays were played with the cross), seed, board words number
+// (0 if the board is built from the seed) followed by the raw little-endian board words,
+// then ( cell << 2 ) | kind per action, an end marker and the score (0 if not won).
+
+enum class replay_action_kind : uint32_t{ click, undo, redo, end };
+
+using replay_action = uint32_t;
+
+constexpr replay_action make_replay_action( replay_action_kind kind, uint32_t cell ) noexcept
+{
+    return cell << 2 | static_cast< uint32_t >( kind );
+}
+
+constexpr replay_action_kind get_replay_action_kind( replay_action action ) noexcept
+{
+    return static_cast< replay_action_kind >( action & 0x3 );
+}
+
+constexpr uint32_t get_replay_action_cell( replay_action action ) noexcept
+{
+    return action >> 2;
+}
+
+struct replay
+{
+    uint32_t grid_size{ 0 };
+    uint32_t buffer_size{ 0 };
+    toggle_rule rule{ toggle_rule::cross };
+    uint64_t seed{ 0 };
+    std::vector< uint64_t > board;
+    std::vector< replay_action > actions;
+    uint32_t score{ 0 };
+
+    // Starting board under the replay's rule, from the stored words or the seed
+    void load_board( game_engine& engine ) const;
+};
+
+void write_replay( std::ostream& out, const replay& game );
+replay read_replay( std::istream& in );
+
+struct replay_result
+{
+    bool solved{ false };
+    uint32_t total_actions{ 0 };
+    uint32_t score{ 0 };
+};
+
+// Plays a replay on a bare engine, its score should match the recorded one
+replay_result play_replay( const replay& game );
+
+#endif
@@ -0,0 +1,140 @@
+#include "score_journal.h"
+
+#include <QSaveFile>
+
+#include "tracing.h"
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+static constexpr int sync_interval_ms{ 1000 };
+
+// CRC-32 of the record without its checksum field
+static uint32_t calc_checksum( const score_record& record ) noexcept
+{
+    uint32_t words[]{ record.kind, record.key, static_cast< uint32_t >( record.value ) };
+    const uchar* data{ reinterpret_cast< const uchar* >( words ) };
+
+    uint32_t crc{ 0xffffffff };
+    for( size_t byte{ 0 }; byte < sizeof( words ); ++byte )
+    {
+        crc ^= data[ byte ];
+        for( int bit{ 0 }; bit < 8; ++bit )
+        {
+            crc = ( crc >> 1 ) ^ ( 0xedb88320 & ( 0 - ( crc & 1 ) ) );
+        }
+    }
+
+    return ~crc;
+}
+
+score_record make_record( const record_kind& kind, uint32_t key, int32_t value ) noexcept
+{
+    score_record record;
+    record.kind = static_cast< uint32_t >( kind );
+    record.key = key;
+    record.value = value;
+    record.checksum = calc_checksum( record );
+
+    return record;
+}
+
+bool is_valid( const score_record& record ) noexcept
+{
+    bool known_kind{ record.kind == static_cast< uint32_t >( record_kind::score ) ||
+                     record.kind == static_cast< uint32_t >( record_kind::top_score ) ||
+                     record.kind == static_cast< uint32_t >( record_kind::sketch_bucket ) };
+
+    return known_kind && record.checksum == calc_checksum( record );
+}
+
+void append_record( QByteArray& records, const score_record& record )
+{
+    records.append( reinterpret_cast< const char* >( &record ), sizeof( score_record ) );
+}
+
+score_journal::score_journal( const QString& file_name, qint64 valid_size, QObject* parent ) :
+    QObject( parent ),
+    m_file_name( file_name ),
+    m_valid_size( valid_size ),
+    m_file( this ),
+    m_sync_timer( this )
+{
+    m_file.setFileName( m_file_name );
+    m_sync_timer.setSingleShot( true );
+    m_sync_timer.setInterval( sync_interval_ms );
+    connect( &m_sync_timer, &QTimer::timeout, this, &score_journal::sync );
+}
+
+void score_journal::open()
+{
+    if( !m_file.open( QFile::ReadWrite ) )
+    {
+        qWarning( "Failed to open scores file" );
+        return;
+    }
+
+    // Drop whatever did not make it to disk in one piece
+    m_file.resize( m_valid_size );
+    m_file.seek( m_valid_size );
+}
+
+void score_journal::append( const QByteArray& records )
+{
+    TRACE_SCOPE( "score_journal::append" );
+
+    if( !m_file.isOpen() )
+    {
+        return;
+    }
+
+    m_file.write( records );
+    if( !m_sync_timer.isActive() )
+    {
+        m_sync_timer.start();
+    }
+}
+
+void score_journal::rewrite( const QByteArray& records )
+{
+    TRACE_SCOPE( "score_journal::rewrite" );
+
+    close();
+
+    // The old journal is replaced atomically, so a crash leaves one of them intact
+    QSaveFile file{ m_file_name };
+    if( !file.open( QFile::WriteOnly ) || file.write( records ) != records.size() || !file.commit() )
+    {
+        // Keep appending to the untouched old journal
+        qWarning( "Failed to compact scores file" );
+        open();
+        return;
+    }
+
+    m_valid_size = records.size();
+    open();
+}
+
+void score_journal::close()
+{
+    if( m_file.isOpen() )
+    {
+        // Everything appended so far is on disk now, reopening must not cut it off
+        sync();
+        m_valid_size = m_file.size();
+        m_file.close();
+    }
+}
+
+void score_journal::sync()
+{
+    TRACE_SCOPE( "score_journal::sync" );
+
+    m_sync_timer.stop();
+    m_file.flush();
+
+#ifdef Q_OS_UNIX
+    ::fsync( m_file.handle() );
+#endif
+}
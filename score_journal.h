@@ -0,0 +1,79 @@
+#ifndef SCORE_JOURNAL_H
+#define SCORE_JOURNAL_H
+
+#include <cstdint>
+#include <cstring>
+
+#include <QFile>
+#include <QTimer>
+#include <QObject>
+#include <QByteArray>
+
+// Append-only score file made of fixed size checksummed records.
+// A torn or corrupted tail is detected by the checksum and cut off on the next start.
+
+// Scores go to the top list and the sketch, compaction leaves only the top lists
+// and the sketch buckets behind. Key is the grid size, or grid size << 8 | bucket for buckets.
+enum class record_kind : uint32_t{ score = 0x31524353,         // "SCR1"
+                                   top_score = 0x31504f54,     // "TOP1"
+                                   sketch_bucket = 0x31424b53 }; // "SKB1"
+
+struct score_record
+{
+    uint32_t kind{ 0 };
+    uint32_t key{ 0 };
+    int32_t value{ 0 };
+    uint32_t checksum{ 0 };
+};
+
+static_assert( sizeof( score_record ) == 16, "Score records should stay 16 bytes long" );
+
+score_record make_record( const record_kind& kind, uint32_t key, int32_t value ) noexcept;
+bool is_valid( const score_record& record ) noexcept;
+void append_record( QByteArray& records, const score_record& record );
+
+// Calls func for every valid record and returns the size of the valid prefix
+template< typename func_type >
+size_t read_records( const uchar* data, size_t size, func_type func )
+{
+    size_t pos{ 0 };
+    for( ; pos + sizeof( score_record ) <= size; pos += sizeof( score_record ) )
+    {
+        score_record record;
+        std::memcpy( &record, data + pos, sizeof( score_record ) );
+        if( !is_valid( record ) )
+        {
+            break;
+        }
+
+        func( record );
+    }
+
+    return pos;
+}
+
+// Writes the journal in its own thread, fsyncs at most once per sync interval
+class score_journal : public QObject
+{
+    Q_OBJECT
+
+public:
+    score_journal( const QString& file_name, qint64 valid_size, QObject* parent = nullptr );
+
+public slots:
+    void open();
+    void append( const QByteArray& records );
+    void rewrite( const QByteArray& records );
+    void close();
+
+private slots:
+    void sync();
+
+private:
+    QString m_file_name;
+    qint64 m_valid_size{ 0 };
+    QFile m_file;
+    QTimer m_sync_timer;
+};
+
+#endif
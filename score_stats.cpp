@@ -0,0 +1,97 @@
+#include "score_stats.h"
+
+#include <algorithm>
+#include <functional>
+
+leaderboard::leaderboard( size_t max_size ) : m_max_size( max_size )
+{
+    m_heap.reserve( max_size );
+}
+
+void leaderboard::add( int score )
+{
+    if( m_heap.size() < m_max_size )
+    {
+        m_heap.push_back( score );
+        std::push_heap( m_heap.begin(), m_heap.end(), std::greater< int >{} );
+    }
+    else if( m_max_size && score > m_heap.front() )
+    {
+        // Replace the lowest score of the list
+        std::pop_heap( m_heap.begin(), m_heap.end(), std::greater< int >{} );
+        m_heap.back() = score;
+        std::push_heap( m_heap.begin(), m_heap.end(), std::greater< int >{} );
+    }
+}
+
+size_t leaderboard::max_size() const noexcept
+{
+    return m_max_size;
+}
+
+const std::vector< int >& leaderboard::get_scores() const noexcept
+{
+    return m_heap;
+}
+
+std::vector< int > leaderboard::get_sorted() const
+{
+    std::vector< int > scores( m_heap );
+    std::sort( scores.begin(), scores.end(), std::greater< int >{} );
+
+    return scores;
+}
+
+score_sketch::score_sketch( int max_score ) :
+    m_bucket_width( std::max( 1, ( max_score + static_cast< int >( buckets_num ) ) / static_cast< int >( buckets_num ) ) )
+{
+    m_counts.fill( 0 );
+}
+
+void score_sketch::add( int score )
+{
+    add_to_bucket( get_bucket( score ), 1 );
+}
+
+void score_sketch::add_to_bucket( size_t bucket, uint64_t count )
+{
+    m_counts[ std::min( bucket, buckets_num - 1 ) ] += count;
+    m_total += count;
+}
+
+size_t score_sketch::get_bucket( int score ) const noexcept
+{
+    return std::min( static_cast< size_t >( std::max( score, 0 ) / m_bucket_width ), buckets_num - 1 );
+}
+
+uint64_t score_sketch::get_count( size_t bucket ) const noexcept
+{
+    return m_counts[ bucket ];
+}
+
+uint64_t score_sketch::total() const noexcept
+{
+    return m_total;
+}
+
+double score_sketch::fraction_below( int score ) const noexcept
+{
+    if( !m_total )
+    {
+        return 0.0;
+    }
+
+    size_t bucket{ get_bucket( score ) };
+
+    uint64_t below{ 0 };
+    for( size_t prev_bucket{ 0 }; prev_bucket < bucket; ++prev_bucket )
+    {
+        below += m_counts[ prev_bucket ];
+    }
+
+    // Scores are assumed to be spread evenly inside a bucket
+    double pos_in_bucket{ double( std::max( score, 0 ) - static_cast< int >( bucket ) * m_bucket_width ) / m_bucket_width };
+    double fraction{ ( below + std::min( pos_in_bucket, 1.0 ) * m_counts[ bucket ] ) / m_total };
+
+    return std::min( fraction, 1.0 );
+}
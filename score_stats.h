@@ -0,0 +1,53 @@
+#ifndef SCORE_STATS_H
+#define SCORE_STATS_H
+
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Best scores of one grid size kept in a min heap, so a new score costs O(log K)
+class leaderboard
+{
+public:
+    explicit leaderboard( size_t max_size );
+
+    void add( int score );
+    size_t max_size() const noexcept;
+
+    // Unordered, cheap to walk through
+    const std::vector< int >& get_scores() const noexcept;
+
+    // Best first
+    std::vector< int > get_sorted() const;
+
+private:
+    size_t m_max_size{ 0 };
+    std::vector< int > m_heap;
+};
+
+// Histogram of scores with a fixed number of equal buckets, memory does not grow with games
+class score_sketch
+{
+public:
+    static constexpr size_t buckets_num{ 256 };
+
+    explicit score_sketch( int max_score );
+
+    void add( int score );
+    void add_to_bucket( size_t bucket, uint64_t count );
+
+    size_t get_bucket( int score ) const noexcept;
+    uint64_t get_count( size_t bucket ) const noexcept;
+    uint64_t total() const noexcept;
+
+    // Share of the recorded games with a lower score, interpolated inside the score's bucket
+    double fraction_below( int score ) const noexcept;
+
+private:
+    int m_bucket_width{ 1 };
+    uint64_t m_total{ 0 };
+    std::array< uint64_t, buckets_num > m_counts;
+};
+
+#endif
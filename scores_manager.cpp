@@ -1,26 +1,67 @@
 #include "scores_manager.h"
 
+#include <algorithm>
+
 #include <QFile>
 #include <QDataStream>
 
-scores_manager::scores_manager( const QString& file_name, size_t max_records ):
+#include "score_journal.h"
+#include "tracing.h"
+
+static constexpr size_t min_records_to_compact{ 1024 };
+static constexpr uint32_t bucket_bits{ 8 };
+
+static_assert( score_sketch::buckets_num <= 1 << bucket_bits, "Sketch buckets should fit into the record key" );
+
+scores_manager::scores_manager( const QString& file_name, size_t max_records, size_t grid_size ):
     m_file_name( file_name ),
-    m_max_recors( max_records )
+    m_max_recors( max_records ),
+    m_grid_size( grid_size )
 {
-    read_from_file();
+    size_t valid_size{ read_from_file() };
+    bool legacy_file{ !valid_size && read_legacy_file() };
+
+    m_journal.reset( new score_journal{ m_file_name, static_cast< qint64 >( valid_size ) } );
+    m_journal->moveToThread( &m_writer_thread );
+
+    // Runs in the writer thread right before it stops
+    QObject::connect( &m_writer_thread, &QThread::finished,
+                      m_journal.get(), &score_journal::close,
+                      Qt::DirectConnection );
+
+    m_writer_thread.start();
+
+    if( legacy_file )
+    {
+        compact();
+    }
+    else
+    {
+        QMetaObject::invokeMethod( m_journal.get(), "open", Qt::QueuedConnection );
+    }
+}
+
+scores_manager::~scores_manager()
+{
+    m_writer_thread.quit();
+    m_writer_thread.wait();
 }
 
 void scores_manager::on_victory( int score )
 {
-    m_scores.push_back( score );
-    std::sort( m_scores.begin(), m_scores.end() );
+    TRACE_SCOPE( "scores_manager::on_victory" );
+
+    score_record record{ make_record( record_kind::score, static_cast< uint32_t >( m_grid_size ), score ) };
+    add_record( record );
 
-    if( m_scores.size() > m_max_recors )
+    QByteArray records;
+    append_record( records, record );
+    QMetaObject::invokeMethod( m_journal.get(), "append", Qt::QueuedConnection, Q_ARG( QByteArray, records ) );
+
+    if( ++m_journal_records >= std::max( min_records_to_compact, 4 * m_compacted_records ) )
     {
-        m_scores.pop_front();
+        compact();
     }
-
-    save_to_file();
 }
 
 size_t scores_manager::max_scores_num() const noexcept
@@ -28,50 +69,166 @@ size_t scores_manager::max_scores_num() const noexcept
     return m_max_recors;
 }
 
-const std::deque< int >& scores_manager::get_scores() const noexcept
+std::vector< int > scores_manager::get_scores() const
 {
-    return m_scores;
+    const grid_scores* scores{ find_grid_scores( m_grid_size ) };
+    return scores? scores->top.get_sorted() : std::vector< int >{};
 }
 
-void scores_manager::save_to_file()
+uint64_t scores_manager::games_num() const
 {
-    QFile file{ m_file_name };
-    file.open( QFile::ReadWrite );
-    if( !file.isOpen() )
+    const grid_scores* scores{ find_grid_scores( m_grid_size ) };
+    return scores? scores->sketch.total() : 0;
+}
+
+double scores_manager::fraction_below( int score ) const
+{
+    const grid_scores* scores{ find_grid_scores( m_grid_size ) };
+    return scores? scores->sketch.fraction_below( score ) : 0.0;
+}
+
+scores_manager::grid_scores& scores_manager::get_grid_scores( size_t grid_size )
+{
+    auto it = m_scores.find( grid_size );
+    if( it == m_scores.end() )
     {
-        throw std::ios_base::failure{ "Failed to open file" };
+        // A solved grid scores grid_size * 100 at most
+        grid_scores scores{ leaderboard{ m_max_recors }, score_sketch{ static_cast< int >( grid_size * 100 ) } };
+        it = m_scores.emplace( grid_size, scores ).first;
     }
 
-    QDataStream out{ &file };
-    for( int score : m_scores )
+    return it->second;
+}
+
+const scores_manager::grid_scores* scores_manager::find_grid_scores( size_t grid_size ) const
+{
+    auto it = m_scores.find( grid_size );
+    return it != m_scores.end()? &it->second : nullptr;
+}
+
+void scores_manager::add_record( const score_record& record )
+{
+    if( record.kind == static_cast< uint32_t >( record_kind::sketch_bucket ) )
     {
-        out << score;
+        get_grid_scores( record.key >> bucket_bits ).sketch.add_to_bucket( record.key & ( ( 1 << bucket_bits ) - 1 ),
+                                                                           static_cast< uint32_t >( record.value ) );
+        return;
+    }
+
+    // Scores recorded before grid sizes were tracked belong to the current one
+    grid_scores& scores = get_grid_scores( record.key? record.key : m_grid_size );
+    scores.top.add( record.value );
+
+    if( record.kind == static_cast< uint32_t >( record_kind::score ) )
+    {
+        scores.sketch.add( record.value );
     }
 }
 
-void scores_manager::read_from_file()
+void scores_manager::compact()
 {
-    m_scores.clear();
+    TRACE_SCOPE( "scores_manager::compact" );
 
-    if( QFile::exists( m_file_name ) )
+    QByteArray records;
+    for( const auto& size_and_scores : m_scores )
     {
-        QFile file{ m_file_name };
-        file.open( QFile::ReadOnly );
-        if( file.isOpen() )
+        uint32_t grid_size{ static_cast< uint32_t >( size_and_scores.first ) };
+        const grid_scores& scores = size_and_scores.second;
+
+        for( int score : scores.top.get_scores() )
         {
-            QDataStream out{ &file };
-            for( size_t score_num{ 0 }; score_num < m_max_recors; ++score_num )
+            append_record( records, make_record( record_kind::top_score, grid_size, score ) );
+        }
+
+        for( size_t bucket{ 0 }; bucket < score_sketch::buckets_num; ++bucket )
+        {
+            uint64_t count{ scores.sketch.get_count( bucket ) };
+            while( count )
             {
-                int score{ 0 };
-                out >> score;
-                m_scores.push_back( score );
+                // Counts that do not fit into one record are split
+                uint64_t record_count{ std::min< uint64_t >( count, INT32_MAX ) };
+                append_record( records, make_record( record_kind::sketch_bucket,
+                                                     grid_size << bucket_bits | static_cast< uint32_t >( bucket ),
+                                                     static_cast< int32_t >( record_count ) ) );
+                count -= record_count;
             }
         }
     }
-    else
+
+    m_journal_records = m_compacted_records = static_cast< size_t >( records.size() ) / sizeof( score_record );
+    QMetaObject::invokeMethod( m_journal.get(), "rewrite", Qt::QueuedConnection, Q_ARG( QByteArray, records ) );
+}
+
+size_t scores_manager::read_from_file()
+{
+    TRACE_SCOPE( "scores_manager::read_from_file" );
+
+    m_scores.clear();
+    m_journal_records = 0;
+    m_compacted_records = 0;
+
+    QFile file{ m_file_name };
+    if( !file.open( QFile::ReadOnly ) || !file.size() )
+    {
+        return 0;
+    }
+
+    size_t file_size{ static_cast< size_t >( file.size() ) };
+    QByteArray contents;
+
+    const uchar* data{ file.map( 0, file.size() ) };
+    if( !data )
+    {
+        contents = file.readAll();
+        data = reinterpret_cast< const uchar* >( contents.constData() );
+        file_size = static_cast< size_t >( contents.size() );
+    }
+
+    return read_records( data, file_size, [ this ]( const score_record& record )
     {
-        m_scores.resize( m_max_recors );
+        add_record( record );
+
+        if( record.kind != static_cast< uint32_t >( record_kind::score ) )
+        {
+            ++m_compacted_records;
+        }
+
+        ++m_journal_records;
+    } );
+}
+
+// Scores file written by the older versions, a plain list of top scores padded with zeros
+bool scores_manager::read_legacy_file()
+{
+    // Legacy files are exactly the top list, anything else without a valid journal record
+    // is a damaged journal and gets cut to its valid prefix when the journal is opened
+    QFile file{ m_file_name };
+    if( !file.open( QFile::ReadOnly ) ||
+        file.size() != static_cast< qint64 >( m_max_recors * sizeof( int32_t ) ) )
+    {
+        return false;
+    }
+
+    uint32_t first_word{ 0 };
+    if( file.peek( reinterpret_cast< char* >( &first_word ), sizeof( first_word ) ) != sizeof( first_word ) ||
+        first_word == static_cast< uint32_t >( record_kind::score ) ||
+        first_word == static_cast< uint32_t >( record_kind::top_score ) ||
+        first_word == static_cast< uint32_t >( record_kind::sketch_bucket ) )
+    {
+        return false;
+    }
+
+    QDataStream in{ &file };
+    for( qint64 score_num{ 0 }; score_num < file.size() / static_cast< qint64 >( sizeof( int32_t ) ); ++score_num )
+    {
+        int score{ 0 };
+        in >> score;
+
+        if( score > 0 )
+        {
+            add_record( make_record( record_kind::score, static_cast< uint32_t >( m_grid_size ), score ) );
+        }
     }
 
-    std::sort( m_scores.begin(), m_scores.end() );
+    return true;
 }
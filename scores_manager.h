@@ -1,28 +1,61 @@
 #ifndef SCORES_MANAGER_H
 #define SCORES_MANAGER_H
 
-#include <deque>
+#include <map>
+#include <memory>
+#include <vector>
 
 #include <QString>
+#include <QThread>
 
-// Stores and saves top scores
+#include "score_stats.h"
+
+class score_journal;
+struct score_record;
+
+// Keeps top scores and score statistics per grid size,
+// records every victory into a journal written in the background
 class scores_manager
 {
 public:
-    scores_manager( const QString& file_name, size_t max_records );
+    scores_manager( const QString& file_name, size_t max_records, size_t grid_size );
+    ~scores_manager();
+
     void on_victory( int score );
 
     size_t max_scores_num() const noexcept;
-    const std::deque< int >& get_scores() const noexcept;
+
+    // Scores of the current grid size, best first
+    std::vector< int > get_scores() const;
+    uint64_t games_num() const;
+    double fraction_below( int score ) const;
 
 private:
-    void read_from_file();
-    void save_to_file();
+    struct grid_scores
+    {
+        leaderboard top;
+        score_sketch sketch;
+    };
+
+    grid_scores& get_grid_scores( size_t grid_size );
+    const grid_scores* find_grid_scores( size_t grid_size ) const;
+    void add_record( const score_record& record );
+    size_t read_from_file();
+    bool read_legacy_file();
+    void compact();
 
 private:
     QString m_file_name;
     size_t m_max_recors{ 0 };
-    std::deque< int > m_scores;
+    size_t m_grid_size{ 0 };
+    std::map< size_t, grid_scores > m_scores;
+
+    // Records in the journal, it gets compacted once they outnumber the compacted ones a lot
+    size_t m_journal_records{ 0 };
+    size_t m_compacted_records{ 0 };
+
+    QThread m_writer_thread;
+    std::unique_ptr< score_journal > m_journal;
 };
 
 #endif
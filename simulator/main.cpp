@@ -0,0 +1,456 @@
+#include <map>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+#include "game_engine.h"
+#include "solver.h"
+#include "replay.h"
+
+// Plays lots of games without any UI and prints speed, moves and scores statistics
+
+enum class strategy{ random, greedy, solver };
+
+struct simulation_settings
+{
+    size_t grid_size{ 3 };
+    size_t games{ 100000 };
+    size_t threads{ std::max( 1u, std::thread::hardware_concurrency() ) };
+    uint64_t seed{ 0 };
+    strategy play_strategy{ strategy::solver };
+    size_t max_moves{ 0 };
+};
+
+struct simulation_stats
+{
+    uint64_t games{ 0 };
+    uint64_t won_games{ 0 };
+    uint64_t moves{ 0 };
+    std::map< uint32_t, uint64_t > moves_to_win;
+    std::map< uint32_t, uint64_t > scores;
+
+    void merge( const simulation_stats& other )
+    {
+        games += other.games;
+        won_games += other.won_games;
+        moves += other.moves;
+
+        for( const auto& moves_and_count : other.moves_to_win )
+        {
+            moves_to_win[ moves_and_count.first ] += moves_and_count.second;
+        }
+
+        for( const auto& score_and_count : other.scores )
+        {
+            scores[ score_and_count.first ] += score_and_count.second;
+        }
+    }
+};
+
+strategy get_strategy( const std::string& name )
+{
+    if( name == "random" )
+    {
+        return strategy::random;
+    }
+    else if( name == "greedy" )
+    {
+        return strategy::greedy;
+    }
+    else if( name == "solver" )
+    {
+        return strategy::solver;
+    }
+
+    throw std::invalid_argument{ "Strategy should be one of: random, greedy, solver" };
+}
+
+simulation_settings get_settings( int argc, char** argv )
+{
+    enum args_pos{ grid_size_pos = 1,
+                   games_pos,
+                   threads_pos,
+                   seed_pos,
+                   strategy_pos,
+                   max_moves_pos };
+
+    simulation_settings settings;
+
+    if( argc >= grid_size_pos + 1 )
+    {
+        int grid_size{ std::stoi( argv[ grid_size_pos ] ) };
+        if( grid_size <= 0 )
+        {
+            throw std::invalid_argument{ "Grid size should be positive" };
+        }
+
+        settings.grid_size = grid_size;
+    }
+
+    if( argc >= games_pos + 1 )
+    {
+        long long games{ std::stoll( argv[ games_pos ] ) };
+        if( games <= 0 )
+        {
+            throw std::invalid_argument{ "Games number should be positive" };
+        }
+
+        settings.games = games;
+    }
+
+    if( argc >= threads_pos + 1 )
+    {
+        int threads{ std::stoi( argv[ threads_pos ] ) };
+        if( threads <= 0 )
+        {
+            throw std::invalid_argument{ "Threads number should be positive" };
+        }
+
+        settings.threads = threads;
+    }
+
+    if( argc >= seed_pos + 1 )
+    {
+        settings.seed = std::stoull( argv[ seed_pos ] );
+    }
+
+    if( argc >= strategy_pos + 1 )
+    {
+        settings.play_strategy = get_strategy( argv[ strategy_pos ] );
+    }
+
+    if( argc >= max_moves_pos + 1 )
+    {
+        long long max_moves{ std::stoll( argv[ max_moves_pos ] ) };
+        if( max_moves <= 0 )
+        {
+            throw std::invalid_argument{ "Max moves number should be positive" };
+        }
+
+        settings.max_moves = max_moves;
+    }
+
+    if( !settings.max_moves )
+    {
+        settings.max_moves = 4 * settings.grid_size * settings.grid_size;
+    }
+
+    return settings;
+}
+
+// Picks the click that leaves the fewest vertical switches, random one if none helps
+class greedy_player
+{
+public:
+    explicit greedy_player( size_t grid_size ) :
+        m_row_counts( grid_size ),
+        m_col_counts( grid_size ){}
+
+    template< typename rng_type >
+    void next_move( const game_engine& engine, rng_type& rng, size_t& best_row, size_t& best_col )
+    {
+        size_t grid_size{ engine.grid_size() };
+        std::fill( m_row_counts.begin(), m_row_counts.end(), 0 );
+        std::fill( m_col_counts.begin(), m_col_counts.end(), 0 );
+
+        for( size_t row{ 0 }; row < grid_size; ++row )
+        {
+            for( size_t col{ 0 }; col < grid_size; ++col )
+            {
+                if( engine.is_vertical( row, col ) )
+                {
+                    ++m_row_counts[ row ];
+                    ++m_col_counts[ col ];
+                }
+            }
+        }
+
+        // A click flips 2 * grid_size - 1 switches, so it helps if more than half of them are vertical
+        long long best_gain{ 0 };
+        for( size_t row{ 0 }; row < grid_size; ++row )
+        {
+            for( size_t col{ 0 }; col < grid_size; ++col )
+            {
+                long long vertical{ static_cast< long long >( m_row_counts[ row ] + m_col_counts[ col ] ) -
+                                    engine.is_vertical( row, col ) };
+                long long gain{ 2 * vertical - static_cast< long long >( 2 * grid_size - 1 ) };
+
+                if( gain > best_gain )
+                {
+                    best_gain = gain;
+                    best_row = row;
+                    best_col = col;
+                }
+            }
+        }
+
+        if( !best_gain )
+        {
+            best_row = rng() % grid_size;
+            best_col = rng() % grid_size;
+        }
+    }
+
+private:
+    std::vector< size_t > m_row_counts;
+    std::vector< size_t > m_col_counts;
+};
+
+void play_games( const simulation_settings& settings,
+                 std::atomic< uint64_t >& next_game,
+                 simulation_stats& stats )
+{
+    game_engine engine{ settings.grid_size };
+    solver game_solver{ settings.grid_size };
+    greedy_player greedy{ settings.grid_size };
+
+    for( uint64_t game{ next_game++ }; game < settings.games; game = next_game++ )
+    {
+        // Every game has its own seed, so results do not depend on the threads number
+        xoshiro256 rng{ settings.seed + game };
+        fill_random( engine, rng );
+
+        if( settings.play_strategy == strategy::solver )
+        {
+            game_solver.reset( [ &engine ]( size_t row, size_t col ){ return engine.is_vertical( row, col ); } );
+        }
+
+        uint32_t moves{ 0 };
+        while( !engine.is_solved() && moves < settings.max_moves )
+        {
+            size_t row{ 0 };
+            size_t col{ 0 };
+
+            if( settings.play_strategy == strategy::random )
+            {
+                // Raw draws rather than standard distributions keep seeded runs the same on every platform
+                row = rng() % settings.grid_size;
+                col = rng() % settings.grid_size;
+            }
+            else if( settings.play_strategy == strategy::greedy )
+            {
+                greedy.next_move( engine, rng, row, col );
+            }
+            else
+            {
+                // Odd boards with mismatching parities can not be solved
+                if( !game_solver.get_hint( row, col ) )
+                {
+                    break;
+                }
+
+                game_solver.on_click( row, col );
+            }
+
+            engine.click( row, col );
+            ++moves;
+        }
+
+        ++stats.games;
+        stats.moves += moves;
+
+        if( engine.is_solved() )
+        {
+            ++stats.won_games;
+            ++stats.moves_to_win[ moves ];
+            ++stats.scores[ calc_score( settings.grid_size, moves ) ];
+        }
+    }
+}
+
+void print_distribution( const std::string& name, const std::map< uint32_t, uint64_t >& values )
+{
+    static constexpr size_t max_buckets{ 20 };
+
+    std::cout << name << ":";
+    if( values.empty() )
+    {
+        std::cout << " none" << std::endl;
+        return;
+    }
+
+    uint64_t total{ 0 };
+    for( const auto& value_and_count : values )
+    {
+        total += value_and_count.second;
+    }
+
+    std::cout << " min " << values.begin()->first;
+    for( double quantile : { 0.5, 0.9, 0.99 } )
+    {
+        uint64_t seen{ 0 };
+        for( const auto& value_and_count : values )
+        {
+            seen += value_and_count.second;
+            if( seen >= quantile * total )
+            {
+                std::cout << ", p" << quantile * 100 << " " << value_and_count.first;
+                break;
+            }
+        }
+    }
+
+    std::cout << ", max " << values.rbegin()->first << std::endl;
+
+    uint32_t min{ values.begin()->first };
+    uint32_t range{ values.rbegin()->first - min + 1 };
+    uint32_t bucket_width{ static_cast< uint32_t >( ( range + max_buckets - 1 ) / max_buckets ) };
+
+    std::map< uint32_t, uint64_t > buckets;
+    for( const auto& value_and_count : values )
+    {
+        buckets[ min + ( value_and_count.first - min ) / bucket_width * bucket_width ] += value_and_count.second;
+    }
+
+    for( const auto& bucket_and_count : buckets )
+    {
+        std::cout << "  " << bucket_and_count.first;
+        if( bucket_width > 1 )
+        {
+            std::cout << "-" << bucket_and_count.first + bucket_width - 1;
+        }
+
+        std::cout << ": " << bucket_and_count.second
+                  << " (" << 100.0 * bucket_and_count.second / total << "%)" << std::endl;
+    }
+}
+
+struct verification_stats
+{
+    uint64_t replays{ 0 };
+    uint64_t won{ 0 };
+    uint64_t mismatched{ 0 };
+    uint64_t broken{ 0 };
+};
+
+// Replays every file on a bare engine and checks the recorded scores
+void verify_replays( const std::vector< std::string >& file_names,
+                     std::atomic< size_t >& next_file,
+                     verification_stats& stats )
+{
+    for( size_t file{ next_file++ }; file < file_names.size(); file = next_file++ )
+    {
+        ++stats.replays;
+
+        try
+        {
+            std::ifstream in{ file_names[ file ], std::ios::binary };
+            replay game{ read_replay( in ) };
+            replay_result result{ play_replay( game ) };
+
+            if( result.solved )
+            {
+                ++stats.won;
+            }
+
+            if( result.score != game.score )
+            {
+                ++stats.mismatched;
+                std::cout << file_names[ file ] << ": score " << result.score
+                          << ", recorded " << game.score << std::endl;
+            }
+        }
+        catch( const std::exception& e )
+        {
+            ++stats.broken;
+            std::cout << file_names[ file ] << ": " << e.what() << std::endl;
+        }
+    }
+}
+
+int verify( const std::vector< std::string >& file_names )
+{
+    size_t threads_num{ std::max( 1u, std::thread::hardware_concurrency() ) };
+
+    std::atomic< size_t > next_file{ 0 };
+    std::vector< verification_stats > thread_stats( threads_num );
+    std::vector< std::thread > threads;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for( size_t thread{ 0 }; thread < threads_num; ++thread )
+    {
+        threads.emplace_back( verify_replays,
+                              std::cref( file_names ),
+                              std::ref( next_file ),
+                              std::ref( thread_stats[ thread ] ) );
+    }
+
+    verification_stats stats;
+    for( size_t thread{ 0 }; thread < threads_num; ++thread )
+    {
+        threads[ thread ].join();
+        stats.replays += thread_stats[ thread ].replays;
+        stats.won += thread_stats[ thread ].won;
+        stats.mismatched += thread_stats[ thread ].mismatched;
+        stats.broken += thread_stats[ thread ].broken;
+    }
+
+    double seconds{ std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count() };
+
+    std::cout << "Replays: " << stats.replays << ", won: " << stats.won
+              << ", score mismatches: " << stats.mismatched
+              << ", unreadable: " << stats.broken << std::endl;
+    std::cout << "Time: " << seconds << " s, " << stats.replays / seconds << " replays/sec" << std::endl;
+
+    return stats.mismatched || stats.broken? -1 : 0;
+}
+
+int main( int argc, char* argv[] )
+{
+    int return_code{ 0 };
+
+    try
+    {
+        if( argc >= 2 && std::string{ argv[ 1 ] } == "--verify" )
+        {
+            return verify( std::vector< std::string >( argv + 2, argv + argc ) );
+        }
+
+        simulation_settings settings{ get_settings( argc, argv ) };
+
+        std::atomic< uint64_t > next_game{ 0 };
+        std::vector< simulation_stats > thread_stats( settings.threads );
+        std::vector< std::thread > threads;
+
+        auto start = std::chrono::steady_clock::now();
+
+        for( size_t thread{ 0 }; thread < settings.threads; ++thread )
+        {
+            threads.emplace_back( play_games,
+                                  std::cref( settings ),
+                                  std::ref( next_game ),
+                                  std::ref( thread_stats[ thread ] ) );
+        }
+
+        simulation_stats stats;
+        for( size_t thread{ 0 }; thread < settings.threads; ++thread )
+        {
+            threads[ thread ].join();
+            stats.merge( thread_stats[ thread ] );
+        }
+
+        double seconds{ std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count() };
+
+        std::cout << "Games: " << stats.games << ", won: " << stats.won_games
+                  << " (" << 100.0 * stats.won_games / stats.games << "%)" << std::endl;
+        std::cout << "Time: " << seconds << " s, "
+                  << stats.games / seconds << " games/sec, "
+                  << stats.moves / seconds << " moves/sec" << std::endl;
+
+        print_distribution( "Moves to win", stats.moves_to_win );
+        print_distribution( "Scores", stats.scores );
+    }
+    catch( const std::exception& e )
+    {
+        std::cerr << e.what() << std::endl;
+        return_code = -1;
+    }
+
+    return return_code;
+}
@@ -0,0 +1,18 @@
+#-------------------------------------------------
+#
+# Headless batch simulation of many games
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = simulator
+TEMPLATE = app
+
+CONFIG += c++11 console thread
+CONFIG -= app_bundle
+
+include(../engine.pri)
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,617 @@
+#include "solver.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+static constexpr size_t bits_per_word{ 64 };
+
+constexpr size_t solver::max_system_grid_size;
+
+// Up to this size every row flip pattern of an odd board is checked
+static constexpr size_t exact_search_max_grid_size{ 11 };
+
+// Up to this null space size of other rules every equivalent solution is checked
+static constexpr size_t exact_search_max_null_space{ 16 };
+
+inline size_t popcount( uint64_t word ) noexcept
+{
+    return static_cast< size_t >( __builtin_popcountll( word ) );
+}
+
+struct solver::system_builder
+{
+    using result_type = void ( * )( solver& target );
+
+    template< typename rule_type >
+    static result_type make() noexcept
+    {
+        return &build_system< rule_type >;
+    }
+};
+
+solver::solver( size_t grid_size, const toggle_rule& rule ) :
+    m_grid_size( grid_size ),
+    m_words_per_row( ( grid_size + bits_per_word - 1 ) / bits_per_word ),
+    m_rule( rule ),
+    m_solution( m_grid_size * m_words_per_row, 0 )
+{
+    if( grid_size <= 0 )
+    {
+        throw std::invalid_argument{ "Grid size should be positive" };
+    }
+
+    size_t tail_bits{ grid_size % bits_per_word };
+    m_last_word_mask = tail_bits? ( uint64_t{ 1 } << tail_bits ) - 1 : ~uint64_t{ 0 };
+
+    if( m_rule != toggle_rule::cross && is_supported() )
+    {
+        make_for_rule< system_builder >( m_rule )( *this );
+    }
+}
+
+template< typename rule_type >
+void solver::build_system( solver& target )
+{
+    size_t cells{ target.m_grid_size * target.m_grid_size };
+    size_t words{ ( cells + bits_per_word - 1 ) / bits_per_word };
+
+    // A row per switch with a bit per click flipping it, and the identity to record row operations
+    std::vector< uint64_t > matrix( cells * words, 0 );
+    std::vector< uint64_t >& transform = target.m_transform;
+    transform.assign( cells * words, 0 );
+
+    for( size_t click{ 0 }; click < cells; ++click )
+    {
+        transform[ click * words + click / bits_per_word ] |= uint64_t{ 1 } << ( click % bits_per_word );
+
+        rule_type::for_each_toggled( target.m_grid_size,
+                                     click / target.m_grid_size,
+                                     click % target.m_grid_size,
+                                     [ & ]( size_t row, size_t col, size_t )
+        {
+            size_t cell{ row * target.m_grid_size + col };
+            matrix[ cell * words + click / bits_per_word ] |= uint64_t{ 1 } << ( click % bits_per_word );
+        } );
+    }
+
+    auto add_row = [ words ]( std::vector< uint64_t >& rows, size_t from, size_t to )
+    {
+        for( size_t word{ 0 }; word < words; ++word )
+        {
+            rows[ to * words + word ] ^= rows[ from * words + word ];
+        }
+    };
+
+    auto swap_rows = [ words ]( std::vector< uint64_t >& rows, size_t first, size_t second )
+    {
+        std::swap_ranges( rows.begin() + first * words, rows.begin() + ( first + 1 ) * words, rows.begin() + second * words );
+    };
+
+    // Gauss-Jordan elimination over GF(2)
+    size_t rank{ 0 };
+    std::vector< bool > is_pivot( cells, false );
+    target.m_pivot_cells.clear();
+
+    for( size_t click{ 0 }; click < cells && rank < cells; ++click )
+    {
+        size_t word{ click / bits_per_word };
+        uint64_t bit{ uint64_t{ 1 } << ( click % bits_per_word ) };
+
+        size_t pivot{ rank };
+        while( pivot < cells && !( matrix[ pivot * words + word ] & bit ) )
+        {
+            ++pivot;
+        }
+
+        if( pivot == cells )
+        {
+            continue;
+        }
+
+        swap_rows( matrix, pivot, rank );
+        swap_rows( transform, pivot, rank );
+
+        for( size_t row{ 0 }; row < cells; ++row )
+        {
+            if( row != rank && ( matrix[ row * words + word ] & bit ) )
+            {
+                add_row( matrix, rank, row );
+                add_row( transform, rank, row );
+            }
+        }
+
+        is_pivot[ click ] = true;
+        target.m_pivot_cells.push_back( click );
+        ++rank;
+    }
+
+    // Every free click with the pivot clicks it forces is a basis vector
+    target.m_null_space.clear();
+    for( size_t click{ 0 }; click < cells; ++click )
+    {
+        if( is_pivot[ click ] )
+        {
+            continue;
+        }
+
+        size_t basis_pos{ target.m_null_space.size() };
+        target.m_null_space.resize( basis_pos + words, 0 );
+        target.m_null_space[ basis_pos + click / bits_per_word ] |= uint64_t{ 1 } << ( click % bits_per_word );
+
+        for( size_t row{ 0 }; row < rank; ++row )
+        {
+            if( ( matrix[ row * words + click / bits_per_word ] >> ( click % bits_per_word ) ) & 1 )
+            {
+                size_t pivot_cell{ target.m_pivot_cells[ row ] };
+                target.m_null_space[ basis_pos + pivot_cell / bits_per_word ] |= uint64_t{ 1 } << ( pivot_cell % bits_per_word );
+            }
+        }
+    }
+
+    target.m_cell_words = words;
+    target.m_rank = rank;
+}
+
+bool solver::is_supported() const noexcept
+{
+    return m_rule == toggle_rule::cross || m_grid_size <= max_system_grid_size;
+}
+
+void solver::on_click( size_t row, size_t col )
+{
+    if( !m_solvable )
+    {
+        return;
+    }
+
+    // x solves A * x = b, so x + e solves A * x = b + A * e
+    flip( row, col );
+    m_solution_size = in_solution( row, col )? m_solution_size + 1 : m_solution_size - 1;
+
+    if( m_rule != toggle_rule::cross )
+    {
+        minimize_system();
+    }
+    else if( m_grid_size % 2 )
+    {
+        minimize();
+    }
+}
+
+bool solver::is_solvable() const noexcept
+{
+    return m_solvable;
+}
+
+size_t solver::solution_size() const noexcept
+{
+    return m_solution_size;
+}
+
+bool solver::in_solution( size_t row, size_t col ) const noexcept
+{
+    const uint64_t& word = m_solution[ row * m_words_per_row + col / bits_per_word ];
+    return ( word >> ( col % bits_per_word ) ) & 1;
+}
+
+bool solver::get_hint( size_t& row, size_t& col ) const noexcept
+{
+    if( !m_solvable || !m_solution_size )
+    {
+        return false;
+    }
+
+    for( size_t word_pos{ 0 }; word_pos < m_solution.size(); ++word_pos )
+    {
+        if( m_solution[ word_pos ] )
+        {
+            row = word_pos / m_words_per_row;
+            col = ( word_pos % m_words_per_row ) * bits_per_word +
+                    static_cast< size_t >( __builtin_ctzll( m_solution[ word_pos ] ) );
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void solver::solve()
+{
+    if( m_rule != toggle_rule::cross )
+    {
+        solve_system();
+        return;
+    }
+
+    // Row parities and column parities of the board
+    std::vector< uint64_t > col_parity( m_words_per_row, 0 );
+    std::vector< bool > row_parity( m_grid_size, false );
+
+    for( size_t row{ 0 }; row < m_grid_size; ++row )
+    {
+        size_t weight{ 0 };
+        for( size_t word{ 0 }; word < m_words_per_row; ++word )
+        {
+            col_parity[ word ] ^= m_solution[ row * m_words_per_row + word ];
+            weight += popcount( m_solution[ row * m_words_per_row + word ] );
+        }
+
+        row_parity[ row ] = weight % 2;
+    }
+
+    if( m_grid_size % 2 == 0 )
+    {
+        // A is its own inverse: x( row, col ) = b( row, col ) + row_parity( row ) + col_parity( col )
+        m_solvable = true;
+        for( size_t row{ 0 }; row < m_grid_size; ++row )
+        {
+            for( size_t word{ 0 }; word < m_words_per_row; ++word )
+            {
+                uint64_t mask{ word + 1 == m_words_per_row? m_last_word_mask : ~uint64_t{ 0 } };
+                m_solution[ row * m_words_per_row + word ] ^=
+                        col_parity[ word ] ^ ( row_parity[ row ]? mask : 0 );
+            }
+        }
+
+        count_solution_size();
+    }
+    else
+    {
+        // Solvable only if all row and column parities are equal, then A * b = b
+        size_t col_parity_weight{ 0 };
+        for( uint64_t word : col_parity )
+        {
+            col_parity_weight += popcount( word );
+        }
+
+        bool parity{ row_parity[ 0 ] };
+        m_solvable = std::all_of( row_parity.begin(), row_parity.end(),
+                                  [ parity ]( bool p ){ return p == parity; } ) &&
+                     col_parity_weight == ( parity? m_grid_size : 0 );
+
+        if( m_solvable )
+        {
+            count_solution_size();
+            minimize();
+        }
+        else
+        {
+            std::fill( m_solution.begin(), m_solution.end(), 0 );
+            m_solution_size = 0;
+        }
+    }
+}
+
+void solver::solve_system()
+{
+    if( !is_supported() )
+    {
+        m_solvable = false;
+        std::fill( m_solution.begin(), m_solution.end(), 0 );
+        m_solution_size = 0;
+        return;
+    }
+
+    std::vector< uint64_t > board;
+    to_cells( board );
+    std::fill( m_solution.begin(), m_solution.end(), 0 );
+
+    m_solvable = true;
+    size_t cells{ m_grid_size * m_grid_size };
+
+    for( size_t row{ 0 }; row < cells && m_solvable; ++row )
+    {
+        size_t weight{ 0 };
+        for( size_t word{ 0 }; word < m_cell_words; ++word )
+        {
+            weight += popcount( m_transform[ row * m_cell_words + word ] & board[ word ] );
+        }
+
+        if( weight % 2 == 0 )
+        {
+            continue;
+        }
+
+        if( row < m_rank )
+        {
+            flip( m_pivot_cells[ row ] / m_grid_size, m_pivot_cells[ row ] % m_grid_size );
+        }
+        else
+        {
+            m_solvable = false;
+        }
+    }
+
+    if( m_solvable )
+    {
+        count_solution_size();
+        minimize_system();
+    }
+    else
+    {
+        std::fill( m_solution.begin(), m_solution.end(), 0 );
+        m_solution_size = 0;
+    }
+}
+
+void solver::minimize_system()
+{
+    size_t basis_size{ m_cell_words? m_null_space.size() / m_cell_words : 0 };
+    if( !basis_size || basis_size > exact_search_max_null_space )
+    {
+        return;
+    }
+
+    std::vector< uint64_t > current;
+    to_cells( current );
+    std::vector< uint64_t > best{ current };
+    size_t best_size{ m_solution_size };
+
+    // Gray code walk, every step adds a single basis vector
+    for( uint64_t step{ 1 }; step < ( uint64_t{ 1 } << basis_size ); ++step )
+    {
+        const uint64_t* basis{ m_null_space.data() + __builtin_ctzll( step ) * m_cell_words };
+
+        size_t size{ 0 };
+        for( size_t word{ 0 }; word < m_cell_words; ++word )
+        {
+            current[ word ] ^= basis[ word ];
+            size += popcount( current[ word ] );
+        }
+
+        if( size < best_size )
+        {
+            best_size = size;
+            best = current;
+        }
+    }
+
+    std::fill( m_solution.begin(), m_solution.end(), 0 );
+    for( size_t cell{ 0 }; cell < m_grid_size * m_grid_size; ++cell )
+    {
+        if( ( best[ cell / bits_per_word ] >> ( cell % bits_per_word ) ) & 1 )
+        {
+            flip( cell / m_grid_size, cell % m_grid_size );
+        }
+    }
+
+    m_solution_size = best_size;
+}
+
+void solver::to_cells( std::vector< uint64_t >& cells ) const
+{
+    cells.assign( m_cell_words, 0 );
+    for( size_t row{ 0 }; row < m_grid_size; ++row )
+    {
+        for( size_t col{ 0 }; col < m_grid_size; ++col )
+        {
+            if( in_solution( row, col ) )
+            {
+                size_t cell{ row * m_grid_size + col };
+                cells[ cell / bits_per_word ] |= uint64_t{ 1 } << ( cell % bits_per_word );
+            }
+        }
+    }
+}
+
+void solver::minimize()
+{
+    if( m_grid_size <= exact_search_max_grid_size )
+    {
+        minimize_exact();
+    }
+    else
+    {
+        minimize_local();
+    }
+}
+
+void solver::minimize_exact()
+{
+    // Columns as bit masks over rows, the grid is small enough for them to fit a word
+    std::vector< uint64_t > cols( m_grid_size, 0 );
+    for( size_t row{ 0 }; row < m_grid_size; ++row )
+    {
+        for( size_t col{ 0 }; col < m_grid_size; ++col )
+        {
+            if( in_solution( row, col ) )
+            {
+                cols[ col ] |= uint64_t{ 1 } << row;
+            }
+        }
+    }
+
+    // Flipping every row and every column changes nothing, so the first row is never flipped
+    size_t best_size{ m_solution_size };
+    uint64_t best_rows{ 0 };
+    uint64_t best_cols{ 0 };
+
+    for( uint64_t rows{ 0 }; rows < ( uint64_t{ 1 } << ( m_grid_size - 1 ) ); ++rows )
+    {
+        uint64_t flipped_rows{ rows << 1 };
+        size_t size{ 0 };
+        uint64_t flipped_cols{ 0 };
+        size_t min_penalty{ m_grid_size };
+        size_t min_penalty_col{ 0 };
+
+        for( size_t col{ 0 }; col < m_grid_size; ++col )
+        {
+            size_t weight{ popcount( cols[ col ] ^ flipped_rows ) };
+            size_t flipped_weight{ m_grid_size - weight };
+            size_t penalty{ weight > flipped_weight? weight - flipped_weight : flipped_weight - weight };
+
+            if( flipped_weight < weight )
+            {
+                flipped_cols |= uint64_t{ 1 } << col;
+            }
+
+            size += std::min( weight, flipped_weight );
+            if( penalty < min_penalty )
+            {
+                min_penalty = penalty;
+                min_penalty_col = col;
+            }
+        }
+
+        // Column flips should have the same parity as row flips
+        if( popcount( flipped_cols ) % 2 != popcount( flipped_rows ) % 2 )
+        {
+            flipped_cols ^= uint64_t{ 1 } << min_penalty_col;
+            size += min_penalty;
+        }
+
+        if( size < best_size )
+        {
+            best_size = size;
+            best_rows = flipped_rows;
+            best_cols = flipped_cols;
+        }
+    }
+
+    for( size_t row{ 0 }; row < m_grid_size; ++row )
+    {
+        if( ( best_rows >> row ) & 1 )
+        {
+            flip_row( row );
+        }
+    }
+
+    for( size_t col{ 0 }; col < m_grid_size; ++col )
+    {
+        if( ( best_cols >> col ) & 1 )
+        {
+            flip_col( col );
+        }
+    }
+
+    m_solution_size = best_size;
+}
+
+void solver::minimize_local()
+{
+    // Exact minimization is the Gale-Berlekamp switching problem, which is NP-hard,
+    // so large odd boards flip pairs of rows or columns while that shrinks the solution
+    auto improve = [ this ]( std::vector< size_t > weights, bool rows )
+    {
+        bool improved{ false };
+        for( ;; )
+        {
+            // Two best lines to flip, flipping a pair keeps the parities equal
+            size_t first{ 0 };
+            size_t second{ 1 };
+            if( weights[ second ] > weights[ first ] )
+            {
+                std::swap( first, second );
+            }
+
+            for( size_t line{ 2 }; line < weights.size(); ++line )
+            {
+                if( weights[ line ] > weights[ first ] )
+                {
+                    second = first;
+                    first = line;
+                }
+                else if( weights[ line ] > weights[ second ] )
+                {
+                    second = line;
+                }
+            }
+
+            if( weights[ first ] + weights[ second ] <= m_grid_size )
+            {
+                return improved;
+            }
+
+            m_solution_size -= weights[ first ] + weights[ second ];
+            m_solution_size += 2 * m_grid_size - weights[ first ] - weights[ second ];
+            weights[ first ] = m_grid_size - weights[ first ];
+            weights[ second ] = m_grid_size - weights[ second ];
+
+            if( rows )
+            {
+                flip_row( first );
+                flip_row( second );
+            }
+            else
+            {
+                flip_col( first );
+                flip_col( second );
+            }
+
+            improved = true;
+        }
+    };
+
+    bool improved{ true };
+    while( improved )
+    {
+        std::vector< size_t > weights( m_grid_size );
+
+        for( size_t row{ 0 }; row < m_grid_size; ++row )
+        {
+            weights[ row ] = row_weight( row );
+        }
+
+        improved = improve( weights, true );
+
+        for( size_t col{ 0 }; col < m_grid_size; ++col )
+        {
+            weights[ col ] = col_weight( col );
+        }
+
+        improved = improve( weights, false ) || improved;
+    }
+}
+
+void solver::flip( size_t row, size_t col ) noexcept
+{
+    m_solution[ row * m_words_per_row + col / bits_per_word ] ^= uint64_t{ 1 } << ( col % bits_per_word );
+}
+
+void solver::flip_row( size_t row ) noexcept
+{
+    for( size_t word{ 0 }; word < m_words_per_row; ++word )
+    {
+        m_solution[ row * m_words_per_row + word ] ^=
+                word + 1 == m_words_per_row? m_last_word_mask : ~uint64_t{ 0 };
+    }
+}
+
+void solver::flip_col( size_t col ) noexcept
+{
+    for( size_t row{ 0 }; row < m_grid_size; ++row )
+    {
+        flip( row, col );
+    }
+}
+
+size_t solver::row_weight( size_t row ) const noexcept
+{
+    size_t weight{ 0 };
+    for( size_t word{ 0 }; word < m_words_per_row; ++word )
+    {
+        weight += popcount( m_solution[ row * m_words_per_row + word ] );
+    }
+
+    return weight;
+}
+
+size_t solver::col_weight( size_t col ) const noexcept
+{
+    size_t weight{ 0 };
+    for( size_t row{ 0 }; row < m_grid_size; ++row )
+    {
+        weight += in_solution( row, col );
+    }
+
+    return weight;
+}
+
+void solver::count_solution_size() noexcept
+{
+    m_solution_size = 0;
+    for( uint64_t word : m_solution )
+    {
+        m_solution_size += popcount( word );
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+#include "toggle_rules.h"
+
+// Finds a minimum set of clicks that opens every lock.
+// A click flips its whole row and column, so the board is a linear system over GF(2):
+// for even grid sizes the system has a unique solution x = A * b, for odd ones
+// it is solvable only if every row and column has the same parity, and the
+// solution is defined up to flipping rows u and columns v with parity( u ) == parity( v ).
+// Other rules have no closed form, their system is eliminated once per solver up to
+// max_system_grid_size and the solution is minimized over a small enough null space.
+// Rows and columns here are zero-based switch coordinates.
+
+class solver
+{
+public:
+    static constexpr size_t max_system_grid_size{ 32 };
+
+    explicit solver( size_t grid_size, const toggle_rule& rule = toggle_rule::cross );
+
+    // False if the rule's system is too large to eliminate, nothing gets solved then
+    bool is_supported() const noexcept;
+
+    // Solves from scratch, is_vertical( row, col ) tells whether the switch is vertical
+    template< typename is_vertical_func >
+    void reset( is_vertical_func is_vertical );
+
+    // Updates the solution after a click without solving the whole board again
+    void on_click( size_t row, size_t col );
+
+    bool is_solvable() const noexcept;
+    size_t solution_size() const noexcept;
+    bool in_solution( size_t row, size_t col ) const noexcept;
+    bool get_hint( size_t& row, size_t& col ) const noexcept;
+
+private:
+    struct system_builder;
+
+    template< typename rule_type >
+    static void build_system( solver& target );
+
+    void solve();
+    void solve_system();
+    void minimize_system();
+    void to_cells( std::vector< uint64_t >& cells ) const;
+    void minimize();
+    void minimize_exact();
+    void minimize_local();
+    void flip( size_t row, size_t col ) noexcept;
+    void flip_row( size_t row ) noexcept;
+    void flip_col( size_t col ) noexcept;
+    size_t row_weight( size_t row ) const noexcept;
+    size_t col_weight( size_t col ) const noexcept;
+    void count_solution_size() noexcept;
+
+private:
+    size_t m_grid_size{ 0 };
+    size_t m_words_per_row{ 0 };
+    uint64_t m_last_word_mask{ 0 };
+    toggle_rule m_rule{ toggle_rule::cross };
+
+    bool m_solvable{ false };
+    size_t m_solution_size{ 0 };
+
+    // Vertical switches first, then the clicks solving them
+    std::vector< uint64_t > m_solution;
+
+    // Eliminated system of other rules over cells row * grid size + col: rows of the transform
+    // map the board to pivot clicks, the rows past the rank have to map it to zero
+    size_t m_cell_words{ 0 };
+    size_t m_rank{ 0 };
+    std::vector< uint64_t > m_transform;
+    std::vector< size_t > m_pivot_cells;
+    std::vector< uint64_t > m_null_space;
+};
+
+template< typename is_vertical_func >
+void solver::reset( is_vertical_func is_vertical )
+{
+    std::fill( m_solution.begin(), m_solution.end(), 0 );
+
+    for( size_t row{ 0 }; row < m_grid_size; ++row )
+    {
+        for( size_t col{ 0 }; col < m_grid_size; ++col )
+        {
+            if( is_vertical( row, col ) )
+            {
+                flip( row, col );
+            }
+        }
+    }
+
+    solve();
+}
+
+#endif
@@ -0,0 +1,33 @@
+#include "toggle_rules.h"
+
+#include <stdexcept>
+
+toggle_rule get_toggle_rule( const std::string& name )
+{
+    if( name == "cross" )
+    {
+        return toggle_rule::cross;
+    }
+    else if( name == "plus" )
+    {
+        return toggle_rule::plus;
+    }
+    else if( name == "diagonal" )
+    {
+        return toggle_rule::diagonal;
+    }
+    else if( name == "torus" )
+    {
+        return toggle_rule::torus;
+    }
+    else if( name == "radius2" )
+    {
+        return toggle_rule::radius2;
+    }
+    else if( name == "radius3" )
+    {
+        return toggle_rule::radius3;
+    }
+
+    throw std::invalid_argument{ "Rule should be one of: cross, plus, diagonal, torus, radius2, radius3" };
+}
@@ -0,0 +1,152 @@
+#ifndef TOGGLE_RULES_H
+#define TOGGLE_RULES_H
+
+#include <limits>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Which switches a click flips. Every rule is a policy calling func( row, col, distance )
+// for the flipped switches, the clicked one first and the rest in the order of distance,
+// so the engine, wave scheduling and the solver are compiled per rule and only pick
+// their instantiation at run time.
+
+enum class toggle_rule : uint32_t{ cross, plus, diagonal, torus, radius2, radius3 };
+
+toggle_rule get_toggle_rule( const std::string& name );
+
+// Switch flipped by a click, distance says in which wave it is shown
+struct toggled_cell
+{
+    uint32_t row;
+    uint32_t col;
+    uint32_t distance;
+};
+
+// Row and column up to radius switches away from the clicked one
+template< size_t radius >
+struct limited_cross_rule
+{
+    template< typename func_type >
+    static void for_each_toggled( size_t grid_size, size_t row, size_t col, func_type func )
+    {
+        func( row, col, 0 );
+
+        for( size_t distance{ 1 }; distance < grid_size && distance <= radius; ++distance )
+        {
+            if( col >= distance )
+            {
+                func( row, col - distance, distance );
+            }
+
+            if( col + distance < grid_size )
+            {
+                func( row, col + distance, distance );
+            }
+
+            if( row >= distance )
+            {
+                func( row - distance, col, distance );
+            }
+
+            if( row + distance < grid_size )
+            {
+                func( row + distance, col, distance );
+            }
+        }
+    }
+};
+
+// Whole row and column, the original game
+using cross_rule = limited_cross_rule< std::numeric_limits< size_t >::max() >;
+
+// Direct neighbours only
+using plus_rule = limited_cross_rule< 1 >;
+
+// Both diagonals up to the edges
+struct diagonal_rule
+{
+    template< typename func_type >
+    static void for_each_toggled( size_t grid_size, size_t row, size_t col, func_type func )
+    {
+        func( row, col, 0 );
+
+        for( size_t distance{ 1 }; distance < grid_size; ++distance )
+        {
+            bool top{ row >= distance };
+            bool bottom{ row + distance < grid_size };
+            bool left{ col >= distance };
+            bool right{ col + distance < grid_size };
+
+            if( top && left )
+            {
+                func( row - distance, col - distance, distance );
+            }
+
+            if( top && right )
+            {
+                func( row - distance, col + distance, distance );
+            }
+
+            if( bottom && left )
+            {
+                func( row + distance, col - distance, distance );
+            }
+
+            if( bottom && right )
+            {
+                func( row + distance, col + distance, distance );
+            }
+        }
+    }
+};
+
+// Direct neighbours wrapping around the edges. On boards too small to have
+// four different neighbours each of them is still flipped once
+struct torus_rule
+{
+    template< typename func_type >
+    static void for_each_toggled( size_t grid_size, size_t row, size_t col, func_type func )
+    {
+        func( row, col, 0 );
+
+        if( grid_size == 1 )
+        {
+            return;
+        }
+
+        size_t left{ ( col + grid_size - 1 ) % grid_size };
+        size_t right{ ( col + 1 ) % grid_size };
+        size_t top{ ( row + grid_size - 1 ) % grid_size };
+        size_t bottom{ ( row + 1 ) % grid_size };
+
+        func( row, left, 1 );
+        if( right != left )
+        {
+            func( row, right, 1 );
+        }
+
+        func( top, col, 1 );
+        if( bottom != top )
+        {
+            func( bottom, col, 1 );
+        }
+    }
+};
+
+// Instantiates maker_type::make< rule_type >() for the rule picked at run time
+template< typename maker_type >
+typename maker_type::result_type make_for_rule( const toggle_rule& rule )
+{
+    switch( rule )
+    {
+    case toggle_rule::plus: return maker_type::template make< plus_rule >();
+    case toggle_rule::diagonal: return maker_type::template make< diagonal_rule >();
+    case toggle_rule::torus: return maker_type::template make< torus_rule >();
+    case toggle_rule::radius2: return maker_type::template make< limited_cross_rule< 2 > >();
+    case toggle_rule::radius3: return maker_type::template make< limited_cross_rule< 3 > >();
+    default: return maker_type::template make< cross_rule >();
+    }
+}
+
+#endif
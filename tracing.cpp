@@ -0,0 +1,142 @@
+#include "tracing.h"
+
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+// Event number n is complete once its slot's sequence is 2 * n + 2, and is being
+// written while it is 2 * n + 1, so dumps skip slots overwritten under them
+struct trace_slot
+{
+    std::atomic< uint64_t > sequence{ 0 };
+    std::atomic< const char* > name{ nullptr };
+    std::atomic< uint64_t > begin_ns{ 0 };
+    std::atomic< uint64_t > end_ns{ 0 };
+};
+
+// Written by its thread only, the counter is published after every event
+struct thread_events
+{
+    size_t thread_id{ 0 };
+    size_t capacity{ 0 };
+    std::unique_ptr< trace_slot[] > slots;
+    std::atomic< uint64_t > written{ 0 };
+};
+
+std::atomic< bool > tracer::m_enabled{ false };
+
+static std::mutex registry_mutex;
+static std::vector< std::unique_ptr< thread_events > > registry;
+static size_t events_capacity{ 0 };
+static std::chrono::steady_clock::time_point start_time;
+
+// Buffers outlive their threads, so events of finished threads still get dumped
+static thread_events* register_thread()
+{
+    std::lock_guard< std::mutex > lock{ registry_mutex };
+
+    std::unique_ptr< thread_events > buffer{ new thread_events };
+    buffer->thread_id = registry.size() + 1;
+    buffer->capacity = events_capacity;
+    buffer->slots.reset( new trace_slot[ events_capacity ] );
+    registry.push_back( std::move( buffer ) );
+
+    return registry.back().get();
+}
+
+void tracer::enable( size_t events_per_thread )
+{
+    if( !events_per_thread )
+    {
+        throw std::invalid_argument{ "Trace buffer size should be positive" };
+    }
+
+    events_capacity = events_per_thread;
+    start_time = std::chrono::steady_clock::now();
+    m_enabled.store( true, std::memory_order_release );
+}
+
+uint64_t tracer::now_ns() noexcept
+{
+    return static_cast< uint64_t >( std::chrono::duration_cast< std::chrono::nanoseconds >(
+                                        std::chrono::steady_clock::now() - start_time ).count() );
+}
+
+void tracer::record( const char* name, uint64_t begin_ns, uint64_t end_ns ) noexcept
+{
+    static thread_local thread_events* buffer{ nullptr };
+    if( !buffer )
+    {
+        buffer = register_thread();
+    }
+
+    uint64_t written{ buffer->written.load( std::memory_order_relaxed ) };
+    trace_slot& slot = buffer->slots[ written % buffer->capacity ];
+
+    slot.sequence.store( 2 * written + 1, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+    slot.name.store( name, std::memory_order_relaxed );
+    slot.begin_ns.store( begin_ns, std::memory_order_relaxed );
+    slot.end_ns.store( end_ns, std::memory_order_relaxed );
+    slot.sequence.store( 2 * written + 2, std::memory_order_release );
+
+    buffer->written.store( written + 1, std::memory_order_release );
+}
+
+void tracer::dump( std::ostream& out )
+{
+    std::lock_guard< std::mutex > lock{ registry_mutex };
+
+    // Timestamps are microseconds
+    std::ios_base::fmtflags flags{ out.flags() };
+    out << std::fixed << std::setprecision( 3 ) << "{\"traceEvents\":[";
+
+    bool first{ true };
+    for( const auto& buffer : registry )
+    {
+        uint64_t written{ buffer->written.load( std::memory_order_acquire ) };
+        uint64_t capacity{ buffer->capacity };
+
+        for( uint64_t pos{ written > capacity? written - capacity : 0 }; pos < written; ++pos )
+        {
+            const trace_slot& slot = buffer->slots[ pos % capacity ];
+
+            uint64_t sequence{ slot.sequence.load( std::memory_order_acquire ) };
+            const char* name{ slot.name.load( std::memory_order_relaxed ) };
+            uint64_t begin_ns{ slot.begin_ns.load( std::memory_order_relaxed ) };
+            uint64_t end_ns{ slot.end_ns.load( std::memory_order_relaxed ) };
+            std::atomic_thread_fence( std::memory_order_acquire );
+
+            // The thread has moved on and is overwriting the slot with a newer event
+            if( sequence != 2 * pos + 2 || slot.sequence.load( std::memory_order_relaxed ) != sequence )
+            {
+                continue;
+            }
+
+            out << ( first? "" : "," ) << "\n{\"name\":\"" << name
+                << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread_id
+                << ",\"ts\":" << begin_ns / 1000.0
+                << ",\"dur\":" << ( end_ns - begin_ns ) / 1000.0 << "}";
+
+            first = false;
+        }
+    }
+
+    out << "\n]}\n";
+    out.flags( flags );
+}
+
+void tracer::dump( const std::string& file_name )
+{
+    std::ofstream out{ file_name, std::ios::trunc };
+    dump( out );
+
+    if( !out )
+    {
+        throw std::ios_base::failure{ "Failed to write trace" };
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include <ostream>
+
+// Opt-in tracing. Scopes go into per-thread ring buffers, so recording never locks,
+// and are dumped as Chrome trace events (chrome://tracing, Perfetto).
+// While disabled a scope costs a single relaxed load.
+
+class tracer
+{
+public:
+    // Keeps the last events_per_thread events of every thread
+    static void enable( size_t events_per_thread );
+    static bool is_enabled() noexcept
+    {
+        return m_enabled.load( std::memory_order_relaxed );
+    }
+
+    static uint64_t now_ns() noexcept;
+    static void record( const char* name, uint64_t begin_ns, uint64_t end_ns ) noexcept;
+
+    // Events being recorded or overwritten during the dump are skipped, never torn
+    static void dump( std::ostream& out );
+    static void dump( const std::string& file_name );
+
+private:
+    static std::atomic< bool > m_enabled;
+};
+
+class trace_scope
+{
+public:
+    explicit trace_scope( const char* name ) noexcept :
+        m_name( tracer::is_enabled()? name : nullptr ),
+        m_begin_ns( m_name? tracer::now_ns() : 0 ){}
+
+    ~trace_scope()
+    {
+        if( m_name )
+        {
+            tracer::record( m_name, m_begin_ns, tracer::now_ns() );
+        }
+    }
+
+    trace_scope( const trace_scope& ) = delete;
+    trace_scope& operator=( const trace_scope& ) = delete;
+
+private:
+    const char* m_name{ nullptr };
+    uint64_t m_begin_ns{ 0 };
+};
+
+#define TRACE_CONCAT_IMPL( left, right ) left##right
+#define TRACE_CONCAT( left, right ) TRACE_CONCAT_IMPL( left, right )
+
+// Name should be a string literal, it is stored by pointer
+#define TRACE_SCOPE( name ) trace_scope TRACE_CONCAT( trace_scope_, __LINE__ ){ name }
+
+#endif
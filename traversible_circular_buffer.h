@@ -1,33 +1,40 @@
 #ifndef TRAVERSIBLE_CIRCULAR_BUFFER_H
 #define TRAVERSIBLE_CIRCULAR_BUFFER_H
 
-#include <deque>
-
-#include <QSize>
+#include <vector>
+#include <stdexcept>
 
 // Regular circular buffer with the ability to
-// travese through it's data back and forth
+// travese through it's data back and forth.
+// Storage is allocated once, dropping the redo part only moves the end.
 
 template< typename type >
 class traversible_circular_buffer
 {
 public:
-    explicit traversible_circular_buffer( size_t size ) noexcept : m_max_size( size ){}
-
-    void push( const type& data )
+    explicit traversible_circular_buffer( size_t size ) : m_data( size )
     {
-        if( m_pos != m_data.size() )
+        if( !size )
         {
-            m_data.resize( m_pos );
+            throw std::invalid_argument{ "Buffer size should be positive" };
         }
+    }
 
-        m_data.push_back( data );
-        if( m_data.size() > m_max_size )
+    void push( const type& data ) noexcept
+    {
+        m_data[ get_data_pos( m_pos ) ] = data;
+
+        if( m_pos < m_data.size() )
+        {
+            ++m_pos;
+        }
+        else
         {
-            m_data.pop_front();
+            // Overwrote the oldest element
+            m_head = get_data_pos( 1 );
         }
 
-        m_pos = m_data.size();
+        m_size = m_pos;
     }
 
     const type& next()
@@ -37,7 +44,7 @@ public:
             throw std::out_of_range{ "No next action" };
         }
 
-        return m_data[ m_pos++ ];
+        return m_data[ get_data_pos( m_pos++ ) ];
     }
 
     const type& prev()
@@ -47,17 +54,31 @@ public:
             throw std::out_of_range{ "No prev action" };
         }
 
-        return m_data[ --m_pos ];
+        return m_data[ get_data_pos( --m_pos ) ];
     }
 
-    bool has_next() const noexcept{ return m_pos < m_data.size(); }
+    void clear() noexcept
+    {
+        m_head = m_pos = m_size = 0;
+    }
+
+    bool has_next() const noexcept{ return m_pos < m_size; }
     bool has_prev() const noexcept{ return m_pos > 0; }
-    size_t max_size() const noexcept{ return m_max_size; }
+    size_t max_size() const noexcept{ return m_data.size(); }
+
+private:
+    size_t get_data_pos( size_t offset ) const noexcept
+    {
+        size_t pos{ m_head + offset };
+        return pos < m_data.size()? pos : pos - m_data.size();
+    }
 
 private:
+    // Positions are offsets from the oldest element
+    size_t m_head{ 0 };
     size_t m_pos{ 0 };
-    size_t m_max_size{ 0 };
-    std::deque< type > m_data;
+    size_t m_size{ 0 };
+    std::vector< type > m_data;
 };
 
 #endif
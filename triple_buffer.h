@@ -0,0 +1,68 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single writer / single reader triple buffer.
+// The writer fills back() and publishes it, the reader picks up the latest
+// published value with acquire() and reads front() until the next acquire().
+// Neither side ever waits for the other or sees a half written value.
+
+template< typename type >
+class triple_buffer
+{
+public:
+    // Not thread safe, only for use before both sides start
+    void reset( const type& value )
+    {
+        for( type& buffer : m_buffers )
+        {
+            buffer = value;
+        }
+
+        m_back = 0;
+        m_middle.store( 1 );
+        m_front = 2;
+    }
+
+    // Writer side
+    type& back() noexcept
+    {
+        return m_buffers[ m_back ];
+    }
+
+    void publish() noexcept
+    {
+        m_back = m_middle.exchange( m_back | dirty_flag, std::memory_order_acq_rel ) & index_mask;
+    }
+
+    // Reader side, returns whether a newer value has been picked up
+    bool acquire() noexcept
+    {
+        if( !( m_middle.load( std::memory_order_relaxed ) & dirty_flag ) )
+        {
+            return false;
+        }
+
+        m_front = m_middle.exchange( m_front, std::memory_order_acq_rel ) & index_mask;
+        return true;
+    }
+
+    const type& front() const noexcept
+    {
+        return m_buffers[ m_front ];
+    }
+
+private:
+    static constexpr uint8_t index_mask{ 0x3 };
+    static constexpr uint8_t dirty_flag{ 0x4 };
+
+    type m_buffers[ 3 ];
+
+    uint8_t m_back{ 0 };
+    std::atomic< uint8_t > m_middle{ 1 };
+    uint8_t m_front{ 2 };
+};
+
+#endif